@@ -0,0 +1,43 @@
+#ifndef QTCLIENT_COMMANDBATCHER_H
+#define QTCLIENT_COMMANDBATCHER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QByteArray>
+
+// 控制指令合并器：在一个短时间窗口内收集控制写入，合并为一条type=2消息
+// 同一key在窗口内多次写入时只保留最后一次的值
+class CommandBatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit CommandBatcher(int windowMs = 20, QObject* parent = nullptr);
+
+    // 合并窗口（毫秒），0表示在本轮事件循环结束后立即发送
+    void setWindow(int windowMs);
+    int window() const {
+        return m_timer.interval();
+    }
+
+    // 加入一条控制写入，窗口内第一次写入时启动计时
+    void enqueue(int key, const QString& val);
+
+    // 立即发送所有待发指令
+    void flush();
+
+signals:
+    // 合并后的消息体（JSON）及其包含的key，由调用方发布到"up"主题
+    void batchReady(const QByteArray& payload, const QVector<int>& keys);
+
+private:
+    struct Command {
+        int key;
+        QString val;
+    };
+
+    QVector<Command> m_pending;  // 按首次写入顺序排列的待发指令
+    QTimer m_timer;              // 合并窗口计时器（单次触发）
+};
+
+#endif //QTCLIENT_COMMANDBATCHER_H
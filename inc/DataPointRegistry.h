@@ -0,0 +1,203 @@
+#ifndef QTCLIENT_DATAPOINTREGISTRY_H
+#define QTCLIENT_DATAPOINTREGISTRY_H
+
+#include <QByteArrayView>
+#include <array>
+#include <bit>
+#include <type_traits>
+#include "DeviceState.h"
+
+// 编译期点表：key、设备名、值类型、单位、方向及对应的DeviceState字段
+// 新增上报设备需要三处修改：DeviceState中加成员，DeviceField中加字段位并更新FieldAll，kDataPoints中加一行；
+// 解码、读值、比较、合并以及控制指令的分发表都由成员模板在编译期生成
+namespace DataPointRegistry {
+
+enum class ValueType : quint8 {
+    Bool,   // "true" / "false"
+    Float,  // 浮点数值
+    Int     // 整数值
+};
+
+enum class Direction : quint8 {
+    Report = 1,          // 只采集上报
+    Control = 2,         // 只下发控制
+    ReportControl = 3    // 既上报也可控制
+};
+
+constexpr bool canReport(Direction direction) {
+    return (static_cast<quint8>(direction) & static_cast<quint8>(Direction::Report)) != 0;
+}
+
+constexpr bool canControl(Direction direction) {
+    return (static_cast<quint8>(direction) & static_cast<quint8>(Direction::Control)) != 0;
+}
+
+struct DataPoint {
+    int key;                                      // 点表中的数据点key
+    const char* device;                           // 设备名
+    const char* label;                            // 界面显示名
+    ValueType type;                               // 值类型
+    const char* unit;                             // 单位（无单位为空串）
+    Direction direction;                          // 数据方向
+    DeviceField field;                            // 对应的DeviceState字段位
+    bool (*assign)(DeviceState&, QByteArrayView); // 写入字段，值变化时返回true；只控制的点为nullptr
+    double (*read)(const DeviceState&);           // 读取字段的数值（开关为0/1）；只控制的点为nullptr
+    bool (*differs)(const DeviceState&, const DeviceState&); // 两个状态中该字段是否不同；只控制的点为nullptr
+    void (*copy)(DeviceState&, const DeviceState&);          // 从第二个状态拷贝该字段；只控制的点为nullptr
+};
+
+namespace detail {
+
+// 按成员类型把上报值写入DeviceState的对应字段
+template <auto Member>
+bool assign(DeviceState& state, QByteArrayView val) {
+    using T = std::remove_cvref_t<decltype(state.*Member)>;
+    T value;
+    if constexpr (std::is_same_v<T, bool>) {
+        value = (val == "true");
+    } else {
+        value = static_cast<T>(val.toDouble());
+    }
+    if (state.*Member == value) {
+        return false;
+    }
+    state.*Member = value;
+    return true;
+}
+
+// 按成员类型读取字段数值
+template <auto Member>
+double read(const DeviceState& state) {
+    return static_cast<double>(state.*Member);
+}
+
+template <auto Member>
+bool differs(const DeviceState& a, const DeviceState& b) {
+    return a.*Member != b.*Member;
+}
+
+template <auto Member>
+void copy(DeviceState& to, const DeviceState& from) {
+    to.*Member = from.*Member;
+}
+
+template <typename T>
+constexpr ValueType valueTypeOf() {
+    if constexpr (std::is_same_v<T, bool>) {
+        return ValueType::Bool;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return ValueType::Float;
+    } else {
+        return ValueType::Int;
+    }
+}
+
+} // namespace detail
+
+// 有DeviceState字段的数据点：值类型由字段类型推导
+template <auto Member>
+constexpr DataPoint point(int key, const char* device, const char* label, const char* unit, Direction direction,
+                          DeviceField field) {
+    using T = std::remove_cvref_t<decltype(std::declval<DeviceState&>().*Member)>;
+    return {key, device, label, detail::valueTypeOf<T>(), unit, direction, field, &detail::assign<Member>,
+            &detail::read<Member>, &detail::differs<Member>, &detail::copy<Member>};
+}
+
+// 只下发控制、不参与上报解码的数据点
+constexpr DataPoint controlPoint(int key, const char* device, const char* label, ValueType type, const char* unit,
+                                 DeviceField field) {
+    return {key, device, label, type, unit, Direction::Control, field, nullptr, nullptr, nullptr, nullptr};
+}
+
+inline constexpr DataPoint kDataPoints[] = {
+    // stm32模块（305/306、308/309为阈值，无需采集）
+    point<&DeviceState::ledState>(301, "led", "LED灯", "", Direction::ReportControl, FieldLed),
+    point<&DeviceState::buzzerState>(302, "buzzer", "蜂鸣器", "", Direction::ReportControl, FieldBuzzer),
+    point<&DeviceState::fanState>(303, "fan", "风扇", "", Direction::ReportControl, FieldFan),
+    point<&DeviceState::humidity>(304, "humidity", "湿度", "%", Direction::Report, FieldHumidity),
+    point<&DeviceState::temperature>(307, "temperature", "温度", "°C", Direction::Report, FieldTemperature),
+    point<&DeviceState::infraredState>(310, "infrared", "人体红外", "", Direction::Report, FieldInfrared),
+    point<&DeviceState::doorLockState>(311, "door_lock", "门锁", "", Direction::ReportControl, FieldDoorLock),
+    // modbus模块
+    point<&DeviceState::tvState>(101, "tv", "电视", "", Direction::ReportControl, FieldTv),
+    controlPoint(102, "water_heater_setpoint", "热水器设定温度", ValueType::Int, "°C", FieldWaterHeaterSetpoint),
+    point<&DeviceState::waterHeaterTemp>(103, "water_heater", "热水器水温", "°C", Direction::Report, FieldWaterHeaterTemp),
+    point<&DeviceState::airConditionerState>(104, "air_conditioner", "空调", "", Direction::ReportControl, FieldAirConditioner),
+    point<&DeviceState::airConditionerTemp>(105, "air_conditioner_temp", "空调设定温度", "°C", Direction::ReportControl, FieldAirConditionerTemp),
+};
+
+inline constexpr int kDataPointCount = static_cast<int>(std::size(kDataPoints));
+
+inline constexpr int kMaxKey = [] {
+    int maxKey = 0;
+    for (const DataPoint& p : kDataPoints) {
+        maxKey = p.key > maxKey ? p.key : maxKey;
+    }
+    return maxKey;
+}();
+
+// key -> 点表下标的稠密索引（-1表示未知key）
+inline constexpr auto kKeyIndex = [] {
+    std::array<qint8, kMaxKey + 1> index{};
+    index.fill(-1);
+    for (int i = 0; i < kDataPointCount; ++i) {
+        index[kDataPoints[i].key] = static_cast<qint8>(i);
+    }
+    return index;
+}();
+
+// 字段位序号 -> 点表下标（-1表示该字段没有数据点）
+inline constexpr auto kFieldIndex = [] {
+    std::array<qint8, 32> index{};
+    index.fill(-1);
+    for (int i = 0; i < kDataPointCount; ++i) {
+        index[std::countr_zero(static_cast<quint32>(kDataPoints[i].field))] = static_cast<qint8>(i);
+    }
+    return index;
+}();
+
+static_assert(kDataPointCount < 128, "点表下标用qint8存储");
+static_assert([] {
+    for (int i = 0; i < kDataPointCount; ++i) {
+        for (int j = i + 1; j < kDataPointCount; ++j) {
+            if (kDataPoints[i].key == kDataPoints[j].key || kDataPoints[i].field == kDataPoints[j].field) {
+                return false;
+            }
+        }
+    }
+    return true;
+}(), "点表中的key与字段必须唯一");
+static_assert([] {
+    for (const DataPoint& p : kDataPoints) {
+        if (!std::has_single_bit(static_cast<quint32>(p.field)) || (p.field & ~FieldAll) != 0) {
+            return false;
+        }
+    }
+    return true;
+}(), "每个数据点对应一个字段位，且包含在FieldAll中");
+
+// O(1)：按key查找数据点在点表中的下标，未知key返回-1
+constexpr int indexOf(int key) {
+    return key < 0 || key > kMaxKey ? -1 : kKeyIndex[key];
+}
+
+// O(1)：按key查找数据点，未知key返回nullptr
+constexpr const DataPoint* find(int key) {
+    if (key < 0 || key > kMaxKey || kKeyIndex[key] < 0) {
+        return nullptr;
+    }
+    return &kDataPoints[kKeyIndex[key]];
+}
+
+// O(1)：按单个字段位查找数据点，没有对应数据点返回nullptr
+constexpr const DataPoint* findByField(DeviceField field) {
+    const quint32 bits = static_cast<quint32>(field);
+    if (!std::has_single_bit(bits) || kFieldIndex[std::countr_zero(bits)] < 0) {
+        return nullptr;
+    }
+    return &kDataPoints[kFieldIndex[std::countr_zero(bits)]];
+}
+
+} // namespace DataPointRegistry
+
+#endif //QTCLIENT_DATAPOINTREGISTRY_H
@@ -0,0 +1,63 @@
+#ifndef QTCLIENT_DATAGRAMRECEIVER_H
+#define QTCLIENT_DATAGRAMRECEIVER_H
+
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+// 批量接收UDP数据报：预先分配固定数量的接收缓冲区并反复使用，每个数据报不再单独分配内存
+// Linux上用recvmmsg一次系统调用读取一批数据报，其他平台逐个读取到同一组缓冲区
+// 用法：在readyRead槽函数中
+//     while (const int count = receiver.receiveBatch()) {
+//         for (int i = 0; i < count; ++i) { const auto& datagram = receiver.datagram(i); ... }
+//     }
+class DatagramReceiver {
+public:
+    struct Datagram {
+        const char* data = nullptr;  // 指向内部缓冲区，下次receiveBatch()前有效
+        qsizetype size = 0;
+        QHostAddress sender;
+        quint16 senderPort = 0;
+    };
+
+    struct Stats {
+        quint64 datagrams = 0;
+        quint64 batches = 0;    // 读到数据的批次，datagrams / batches为平均批量
+        quint64 truncated = 0;  // 超过缓冲区大小而丢弃的数据报
+    };
+
+    // socketBufferBytes>0时同时设置内核接收缓冲区，使突发流量不在内核中溢出
+    DatagramReceiver(QUdpSocket* socket, int batchSize = 32, qsizetype bufferSize = 65536, int socketBufferBytes = 0);
+    ~DatagramReceiver();
+
+    // 读取一批数据报，返回数量，0表示已没有待读的数据报
+    int receiveBatch();
+
+    const Datagram& datagram(int index) const {
+        return m_datagrams[index];
+    }
+    const Stats& stats() const {
+        return m_stats;
+    }
+
+private:
+    QUdpSocket* m_socket;
+    int m_batchSize;
+    qsizetype m_bufferSize;
+    std::vector<char> m_buffers;  // m_batchSize个缓冲区连续存放
+    QVector<Datagram> m_datagrams;
+    Stats m_stats;
+    struct NativeBatch;                     // recvmmsg的控制结构，与缓冲区一起预先分配
+    std::unique_ptr<NativeBatch> m_native;
+
+    char* buffer(int index) {
+        return m_buffers.data() + index * m_bufferSize;
+    }
+    // 通过QUdpSocket读取一个数据报；读取后QUdpSocket才会继续发出readyRead
+    bool readOne(int slot);
+    int readNative(int first);  // 从slot first开始用recvmmsg读取剩余的槽
+};
+
+#endif //QTCLIENT_DATAGRAMRECEIVER_H
@@ -0,0 +1,10 @@
+#ifndef QTCLIENT_DECODEBENCHMARK_H
+#define QTCLIENT_DECODEBENCHMARK_H
+
+#include <QString>
+
+// 采集上报解码对比：读取录制文件中的全部报文，分别用原来的QJsonDocument解码
+// 和TelemetryDecoder::decodeReport解码，校验结果一致并输出每条报文的耗时。返回进程退出码
+int runDecodeBenchmark(const QString& capturePath);
+
+#endif //QTCLIENT_DECODEBENCHMARK_H
@@ -0,0 +1,41 @@
+#ifndef QTCLIENT_DETECTIONLOG_H
+#define QTCLIENT_DETECTIONLOG_H
+
+#include <QString>
+#include <QVector>
+#include <QFile>
+#include <atomic>
+
+// 一条检测事件
+struct DetectionEvent {
+    QString timestamp;
+    QString status;
+    QString remark;
+};
+
+// 检测事件的磁盘日志：只追加的UTF-8文本文件，每行一条事件，字段以制表符分隔
+// 界面只保留最近的事件，完整记录保存在这里并可按关键字检索
+class DetectionLog {
+public:
+    explicit DetectionLog(QString path);
+
+    // 默认日志文件：应用数据目录下的detections/infrared.log
+    static QString defaultPath();
+
+    // 一批事件一次写入，失败时返回false（不影响界面显示）
+    bool append(const QVector<DetectionEvent>& events);
+    // 在整个日志中检索包含text（不区分大小写）的事件，返回最近的maxResults条，按时间顺序
+    // 自行打开文件读取，可在工作线程中调用；cancelled非空且被置位时尽快返回空结果
+    QVector<DetectionEvent> search(const QString& text, int maxResults,
+                                   const std::atomic<bool>* cancelled = nullptr) const;
+
+    const QString& path() const {
+        return m_path;
+    }
+
+private:
+    QString m_path;
+    QFile m_file;  // 首次写入时以追加方式打开
+};
+
+#endif //QTCLIENT_DETECTIONLOG_H
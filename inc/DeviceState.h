@@ -0,0 +1,50 @@
+#ifndef QTCLIENT_DEVICESTATE_H
+#define QTCLIENT_DEVICESTATE_H
+
+#include <QtGlobal>
+
+// 设备状态字段位：标记自上次刷新界面以来发生变化的数据点
+// 新增字段位后须同时更新FieldAll（DataPointRegistry中有静态检查）
+enum DeviceField : quint32 {
+    FieldLed = 1u << 0,
+    FieldBuzzer = 1u << 1,
+    FieldFan = 1u << 2,
+    FieldDoorLock = 1u << 3,
+    FieldTv = 1u << 4,
+    FieldInfrared = 1u << 5,
+    FieldAirConditioner = 1u << 6,
+    FieldTemperature = 1u << 7,
+    FieldHumidity = 1u << 8,
+    FieldWaterHeaterTemp = 1u << 9,
+    FieldAirConditionerTemp = 1u << 10,
+    FieldWaterHeaterSetpoint = 1u << 11,  // 热水器预设温度（仅本地设置，不来自上报）
+    FieldAll = (1u << 12) - 1
+};
+
+// 设备状态：与点表一一对应的强类型结构体，由TelemetryDecoder直接写入
+struct DeviceState {
+    // 开关类设备状态（true为开，false为关）
+    bool ledState = false;            // LED灯（key=301）
+    bool buzzerState = false;         // 蜂鸣器（key=302）
+    bool fanState = false;            // 风扇（key=303）
+    bool doorLockState = false;       // 门锁（key=311）
+    bool tvState = false;             // 电视（key=101）
+    bool infraredState = false;       // 人体红外（key=310，检测到/未检测到）
+    bool airConditionerState = false; // 空调开关（key=104）
+
+    // 传感器数据
+    float temperature = 0.0f;         // 温度值（℃，key=307）
+    float humidity = 0.0f;            // 湿度值（%，key=304）
+    float waterHeaterTemp = 0.0f;     // 热水器温度（℃，key=103）
+    int airConditionerTemp = 25;      // 空调设定温度（℃，key=105，默认25℃）
+
+    // 以下按点表逐项处理（见DataPointRegistry），新增数据点不需要修改
+
+    // fields（DeviceField位）标记的字段中，与other取值不同的字段位
+    quint32 differences(const DeviceState& other, quint32 fields) const;
+
+    // 只拷贝fields（DeviceField位）标记的字段，其余保持不变
+    void merge(const DeviceState& from, quint32 fields);
+};
+
+#endif //QTCLIENT_DEVICESTATE_H
@@ -0,0 +1,28 @@
+#ifndef QTCLIENT_DOWNSAMPLER_H
+#define QTCLIENT_DOWNSAMPLER_H
+
+#include <QVector>
+
+// 绘图前的降采样：输入按时间升序，输出为选中点的下标（升序，写入out前先清空）
+// 只输出下标，由调用方直接从原始列构造绘图数据，不产生中间的时间/值副本
+namespace Downsampler {
+    enum class Method {
+        None,    // 不降采样
+        MinMax,  // 每个时间桶保留最小值和最大值，不丢失尖峰
+        Lttb     // Largest-Triangle-Three-Buckets，保留曲线形状
+    };
+
+    // 按时间把[times[0], times[count-1]]均分为buckets个桶，每桶选出最小值点和最大值点
+    // 首尾点始终保留，输出点数不超过2*buckets+2
+    void minMax(const double* times, const double* values, qsizetype count, int buckets, QVector<qsizetype>& out);
+
+    // 选出threshold个点（threshold<3或count<=threshold时选出全部点）
+    void lttb(const double* times, const double* values, qsizetype count, int threshold, QVector<qsizetype>& out);
+
+    // 按绘图区宽度选择输出规模：MinMax每像素一个桶，LTTB每像素两个点
+    // 返回false表示无需降采样（点数已足够少或method为None），此时out为空，应使用全部点
+    bool downsample(Method method, const double* times, const double* values, qsizetype count, int pixels,
+                    QVector<qsizetype>& out);
+}
+
+#endif //QTCLIENT_DOWNSAMPLER_H
@@ -0,0 +1,50 @@
+#ifndef QTCLIENT_FRAMEDECODEPOOL_H
+#define QTCLIENT_FRAMEDECODEPOOL_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QMutex>
+#include <QByteArray>
+#include <QImage>
+
+// 视频帧解码池：压缩帧在少量工作线程中解码，解码结果以可直接绘制的格式发回界面线程
+// 只保留一个待解码帧，新帧到达时尚未开始解码的旧帧直接丢弃；
+// 并行解码时较早的帧若晚于较新的帧完成也丢弃，使显示延迟有上限
+class FrameDecodePool : public QObject {
+    Q_OBJECT
+
+public:
+    explicit FrameDecodePool(int threads = 2, QObject* parent = nullptr);
+    ~FrameDecodePool() override;
+
+    // 线程安全：提交一帧压缩图像
+    void submit(const QByteArray& data);
+
+    quint64 droppedFrames() const;  // 被更新的帧取代而未显示的帧数
+    quint64 failedFrames() const;   // 无法解码的帧数
+
+    // 按文件头判断数据是否为图像（JPEG、PNG、BMP），用于把图像和文本报文分开
+    static bool looksLikeImage(const QByteArray& data);
+
+signals:
+    // 在工作线程中发出，连接到界面对象时为排队连接；sequence严格递增
+    void frameDecoded(const QImage& image, quint64 sequence);
+
+private:
+    QThreadPool m_pool;
+    int m_maxWorkers;
+
+    mutable QMutex m_mutex;  // 保护以下成员
+    QByteArray m_pending;    // 最新的待解码帧
+    bool m_hasPending = false;
+    quint64 m_pendingSequence = 0;
+    quint64 m_nextSequence = 0;
+    quint64 m_lastDelivered = 0;
+    int m_workers = 0;       // 正在运行的解码任务数
+    quint64 m_dropped = 0;
+    quint64 m_failed = 0;
+
+    void work();  // 线程池中执行，处理到没有待解码帧为止
+};
+
+#endif //QTCLIENT_FRAMEDECODEPOOL_H
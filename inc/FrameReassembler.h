@@ -0,0 +1,63 @@
+#ifndef QTCLIENT_FRAMEREASSEMBLER_H
+#define QTCLIENT_FRAMEREASSEMBLER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QMap>
+
+// UDP视频帧分片重组
+// 分片数据报格式（小端）：
+//   "IRF1"  4字节魔数
+//   quint32 帧编号（每帧加1，允许回绕）
+//   quint16 分片序号（从0开始）
+//   quint16 分片总数
+//   之后为该分片的数据，各分片按序号拼接即为完整的一帧
+// 不带魔数的数据报视为一个完整帧，兼容不分片的旧设备
+// 分片可以乱序到达；超时未收齐的帧丢弃，某帧收齐后比它更早的未完成帧也丢弃
+class FrameReassembler {
+public:
+    static constexpr qsizetype kHeaderSize = 12;
+    static constexpr int kMaxFragments = 1024;
+
+    struct Stats {
+        quint64 completeFrames = 0;      // 重组完成的分片帧
+        quint64 incompleteFrames = 0;    // 超时或被更新的帧取代而丢弃的帧
+        quint64 lostFragments = 0;       // 丢弃的帧中缺少的分片数
+        quint64 lateFragments = 0;       // 所属帧已完成或已丢弃后才到达的分片
+        quint64 duplicateFragments = 0;
+        quint64 malformed = 0;           // 头部不合法的数据报
+    };
+
+    explicit FrameReassembler(int timeoutMs = 200, int maxPendingFrames = 8);
+
+    // 处理一个数据报，得到完整帧时写入frame并返回true；只复制数据，不保留data指针
+    bool push(const char* data, qsizetype size, qint64 nowMs, QByteArray& frame);
+    // 丢弃超时的未完成帧
+    void expire(qint64 nowMs);
+    void reset();
+
+    const Stats& stats() const {
+        return m_stats;
+    }
+
+private:
+    struct PendingFrame {
+        QVector<QByteArray> fragments;
+        int received = 0;
+        qsizetype bytes = 0;
+        qint64 firstSeenMs = 0;
+    };
+
+    int m_timeoutMs;
+    int m_maxPendingFrames;
+    QMap<quint32, PendingFrame> m_pending;  // 帧编号 -> 已收到的分片
+    quint32 m_lastFinished = 0;  // 最新的已完成或已丢弃的帧编号，不晚于它的分片不再接收
+    bool m_started = false;
+    Stats m_stats;
+
+    void finish(quint32 frameId);
+    // 丢弃未完成的帧并计入统计，返回下一个位置
+    QMap<quint32, PendingFrame>::iterator drop(QMap<quint32, PendingFrame>::iterator it);
+};
+
+#endif //QTCLIENT_FRAMEREASSEMBLER_H
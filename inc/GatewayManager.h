@@ -0,0 +1,107 @@
+#ifndef QTCLIENT_GATEWAYMANAGER_H
+#define QTCLIENT_GATEWAYMANAGER_H
+
+#include <QObject>
+#include <QMqttClient>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QVector>
+#include <QSet>
+#include <memory>
+#include <vector>
+#include "DeviceState.h"
+
+// 单个网关在汇总视图中的状态
+struct GatewaySnapshot {
+    QString ip;
+    QString topic;
+    QMqttClient::ClientState connection = QMqttClient::Disconnected;
+    DeviceState device;        // 最新设备状态
+    quint32 reported = 0;      // 至少上报过一次的字段位（DeviceField）
+    quint64 messages = 0;      // 收到的报文总数
+    qint64 lastReportMs = 0;   // 最近一次有效上报的时间（Unix毫秒）
+};
+
+class GatewayConnection;
+
+// 多网关管理：一个进程同时管理N个网关
+// MQTT连接按轮转分布在少量网络线程上，报文解码在共享线程池中进行；
+// 同一网关的报文通过串行队列（strand）按到达顺序解码，不同网关之间并行。
+// 界面线程定时调用takeDirty()取得发生变化的网关，不为每个连接注册界面槽函数。
+class GatewayManager : public QObject {
+    Q_OBJECT
+
+public:
+    // networkThreads<=0时按CPU核数的一半选择（至少1个）
+    explicit GatewayManager(int networkThreads = 0, QObject* parent = nullptr);
+    ~GatewayManager() override;
+
+    // 添加网关并开始连接，返回网关编号（从0开始连续分配）
+    int addGateway(const QString& ip, const QString& topic);
+    int gatewayCount() const;
+
+    // 取出自上次调用以来发生变化的网关编号及其快照
+    QVector<int> takeDirty(QVector<GatewaySnapshot>& snapshots);
+
+    // 线程安全：向指定网关发布消息
+    void publish(int id, const QString& topic, const QByteArray& payload);
+
+private:
+    friend class GatewayConnection;
+
+    // 每个网关的解码串行队列，由线程池中的任务依次处理
+    struct Gateway {
+        int id = 0;
+        GatewayConnection* connection = nullptr;  // 运行在某个网络线程上
+        QMutex queueMutex;
+        QVector<QByteArray> queue;                // 待解码的报文
+        bool scheduled = false;                   // 是否已有任务在处理该队列
+        DeviceState state;                        // 仅由处理该队列的任务访问
+        quint32 reported = 0;
+    };
+
+    std::vector<QThread*> m_networkThreads;
+    QThreadPool m_decodePool;                     // 所有网关共享的解码线程池
+    int m_nextThread = 0;
+
+    mutable QMutex m_mutex;                       // 保护以下成员
+    std::vector<std::unique_ptr<Gateway>> m_gateways;
+    QVector<GatewaySnapshot> m_snapshots;
+    QSet<int> m_dirty;
+
+    // 以下由网络线程调用
+    void enqueue(Gateway* gateway, const QByteArray& message);
+    void setConnectionState(int id, QMqttClient::ClientState state);
+
+    void drain(Gateway* gateway);  // 线程池中执行
+};
+
+// 单个网关的MQTT连接：在网络线程中创建并运行，断线后自动重连
+class GatewayConnection : public QObject {
+    Q_OBJECT
+
+public:
+    // gateway在连接的整个生命周期内地址不变，收到报文时直接使用，不再经过管理器的锁查找
+    GatewayConnection(GatewayManager* manager, GatewayManager::Gateway* gateway, QString ip, QString topic);
+
+public slots:
+    void start();
+    void stop();
+    void publish(const QString& topic, const QByteArray& payload);
+
+private slots:
+    void onStateChanged(QMqttClient::ClientState state);
+    void onMessageReceived(const QByteArray& message, const QMqttTopicName& topic);
+
+private:
+    GatewayManager* m_manager;
+    GatewayManager::Gateway* m_gateway;
+    int m_id;
+    QString m_ip;
+    QString m_topic;
+    QMqttClient* m_client = nullptr;
+    bool m_stopping = false;
+};
+
+#endif //QTCLIENT_GATEWAYMANAGER_H
@@ -0,0 +1,26 @@
+#ifndef QTCLIENT_GORILLACODEC_H
+#define QTCLIENT_GORILLACODEC_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+
+// 历史数据的Gorilla压缩编码（时间用二阶差分，值用与前值异或）
+//   quint32 点数（小端）
+//   比特流（高位在前）：
+//     第一个点：64位时间（毫秒）+ 64位值（IEEE 754）
+//     之后每个点：
+//       时间二阶差分D：'0'表示D=0；'10'+7位；'110'+9位；'1110'+12位；'1111'+64位
+//       值异或X：'0'表示与前值相同；'10'+沿用上一个有效位窗口的有效位；
+//                '11'+5位前导零数+6位有效位数-1+有效位
+// 定时采样的数据大多数点只需2个比特
+namespace GorillaCodec {
+    // 把count个点追加编码到out，times为Unix秒（按毫秒精度保存）
+    void encode(const double* times, const double* values, qsizetype count, QByteArray& out);
+
+    // 解码block并追加到列缓冲区，返回false表示数据截断或格式错误（列缓冲区保持原样）
+    // consumed非空时返回block中本段数据的字节数
+    bool decode(QByteArrayView block, QVector<double>& times, QVector<double>& values, qsizetype* consumed = nullptr);
+}
+
+#endif //QTCLIENT_GORILLACODEC_H
@@ -0,0 +1,8 @@
+#ifndef QTCLIENT_HISTORYBENCHMARK_H
+#define QTCLIENT_HISTORYBENCHMARK_H
+
+// 历史数据编码对比：生成points个1秒间隔的温度点，分别编码为JSON回复与二进制回复，
+// 经HistoryClient::parsePage解码，输出报文字节数与解码耗时。返回进程退出码
+int runHistoryBenchmark(int points);
+
+#endif //QTCLIENT_HISTORYBENCHMARK_H
@@ -0,0 +1,66 @@
+#ifndef QTCLIENT_HISTORYCACHE_H
+#define QTCLIENT_HISTORYCACHE_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+// 本地历史数据缓存：每个数据点key一组列式文件，通过内存映射读取
+//   <key>.t      double数组，时间（Unix秒），升序
+//   <key>.v      double数组，与时间一一对应的值
+//   <key>.ranges qint64对数组，已完整取回的时间区间（闭区间，升序且互不重叠）
+// 区间索引记录哪些时间段已在本地，查询时只需向网关请求缺口
+// 非线程安全，由界面线程使用
+class HistoryCache {
+public:
+    struct Interval {
+        qint64 start;
+        qint64 end;
+    };
+
+    // directory不存在时自动创建；通常每个网关一个目录
+    explicit HistoryCache(QString directory);
+    ~HistoryCache();
+
+    HistoryCache(const HistoryCache&) = delete;
+    HistoryCache& operator=(const HistoryCache&) = delete;
+
+    // 默认缓存目录：<应用数据目录>/history/<网关主题>
+    static QString defaultDirectory(const QString& gatewayTopic);
+
+    // [start, end]中尚未缓存的区间，按时间升序
+    QVector<Interval> missing(int key, qint64 start, qint64 end);
+
+    // 写入从网关取回的[start, end]完整数据（times升序），覆盖该区间内原有的点
+    // 返回false表示写文件失败，此时区间不标记为已缓存
+    bool store(int key, qint64 start, qint64 end, const QVector<double>& times, const QVector<double>& values);
+
+    // 读出[start, end]内已缓存的点
+    void read(int key, qint64 start, qint64 end, QVector<double>& times, QVector<double>& values);
+
+    // 删除全部缓存文件
+    void clear();
+
+private:
+    struct Column {
+        QFile timeFile;
+        QFile valueFile;
+        const double* times = nullptr;   // 映射到timeFile
+        const double* values = nullptr;  // 映射到valueFile
+        qint64 count = 0;
+        QVector<Interval> ranges;
+    };
+
+    QString m_directory;
+    QHash<int, std::shared_ptr<Column>> m_columns;
+
+    Column& column(int key);
+    QString path(int key, const char* suffix) const;
+    static bool map(Column& column);
+    static void unmap(Column& column);
+    bool writeRanges(int key, const QVector<Interval>& ranges) const;
+};
+
+#endif //QTCLIENT_HISTORYCACHE_H
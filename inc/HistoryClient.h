@@ -0,0 +1,96 @@
+#ifndef QTCLIENT_HISTORYCLIENT_H
+#define QTCLIENT_HISTORYCLIENT_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include <QMqttTopicName>
+
+class MqttIngestWorker;
+
+// 历史数据查询（type=4）：每个请求携带关联编号id，多个请求同时发出，回复按id匹配
+// 不回显id的旧网关按key匹配最早发出的同key请求
+//
+// 分页：请求中的page_size为每页最多点数，网关在回复的next字段给出续传令牌，
+// 客户端用同一id和cursor=令牌请求下一页，直到回复不再带next。
+// 不支持分页的网关忽略page_size，一次返回全部数据，即只有一页
+//
+// 二进制编码：请求中带encoding="gorilla"，支持的网关以二进制报文回复（小端）：
+//   magic "QTH" + quint8 版本(1) + quint32 id + qint32 key + qint32 result
+//   + quint16 续传令牌长度 + 令牌（UTF-8）+ Gorilla压缩的数据段（见GorillaCodec.h）
+// 不支持的网关忽略encoding，仍以JSON回复
+class HistoryClient : public QObject {
+    Q_OBJECT
+
+public:
+    explicit HistoryClient(MqttIngestWorker* worker, int timeoutMs = 10000, QObject* parent = nullptr);
+
+    // 每页最多点数，0表示不分页
+    void setPageSize(int points) {
+        m_pageSize = qMax(0, points);
+    }
+
+    // 是否请求二进制编码（默认开启）
+    void setBinaryEncoding(bool enabled) {
+        m_binaryEncoding = enabled;
+    }
+
+    // 一页回复的解析结果
+    struct Page {
+        bool hasId = false;  // 旧网关不回显id
+        quint32 id = 0;
+        int key = 0;
+        int result = 0;
+        QString next;        // 续传令牌，空表示最后一页
+        QVector<double> times;
+        QVector<double> values;
+    };
+
+    // 解析一条type=4回复（JSON或二进制），不是历史回复或格式错误时返回false
+    // 数据按时间升序写入page的列缓冲区
+    static bool parsePage(const QByteArray& message, Page& page);
+
+    // 发出一个历史查询，返回关联编号（非0）
+    quint32 request(int key, qint64 startTime, qint64 endTime);
+
+    // 放弃请求，不再请求后续页，之后收到的对应回复被忽略
+    void cancel(quint32 id);
+    void cancelAll();
+
+    int pendingCount() const {
+        return static_cast<int>(m_pending.size());
+    }
+
+signals:
+    // 收到一页数据（时间为Unix秒，按时间升序），finished表示是最后一页
+    // progress为该请求已取回的时间范围比例（0~1）
+    void pageReceived(quint32 id, int key, const QVector<double>& times, const QVector<double>& values,
+                      double progress, bool finished);
+    void requestFailed(quint32 id, int key, const QString& reason);
+
+private slots:
+    void onMessageReceived(const QByteArray& message, const QMqttTopicName& topic);
+    void onTimeout();
+
+private:
+    struct Request {
+        int key;
+        qint64 startTime;
+        qint64 endTime;
+        qint64 sentMs;  // 最近一页请求的发出时间，用于超时判断
+    };
+
+    MqttIngestWorker* m_worker;
+    int m_timeoutMs;
+    int m_pageSize = 2000;
+    bool m_binaryEncoding = true;
+    quint32 m_nextId = 1;
+    QHash<quint32, Request> m_pending;
+    QTimer m_timeoutTimer;
+
+    void send(quint32 id, const Request& request, const QString& cursor);
+    quint32 matchByKey(int key) const;
+};
+
+#endif //QTCLIENT_HISTORYCLIENT_H
@@ -0,0 +1,53 @@
+#ifndef QTCLIENT_HISTORYEXPORTER_H
+#define QTCLIENT_HISTORYEXPORTER_H
+
+#include <QObject>
+#include <QSaveFile>
+#include <QVector>
+
+// 历史数据导出：在工作线程中逐页写文件，不在内存中保留完整结果
+// 所有槽函数通过排队连接调用，文件在finish()成功后才替换到目标路径
+//
+// CSV：每行 key,timestamp,time,value（多个数据点的页交错到达，按到达顺序写出）
+// 列式二进制（小端）：
+//   文件头：magic "QTHX" + quint8 版本 + 3字节保留 + quint64 总点数 + quint32 数据块数
+//   数据块：qint32 key + quint32 点数n + n个double时间（Unix秒）+ n个double值
+//   每页一个数据块，总点数和块数在结束时回填
+class HistoryExporter : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Csv,
+        Columnar
+    };
+
+    HistoryExporter(QString path, Format format, QObject* parent = nullptr);
+
+    // 按文件扩展名选择格式：.qthx为列式二进制，其余为CSV
+    static Format formatForPath(const QString& path);
+
+public slots:
+    void open();
+    void writePage(int key, const QVector<double>& times, const QVector<double>& values);
+    void finish();  // 提交文件
+    void abort();   // 放弃导出，不生成目标文件
+
+signals:
+    // 导出结束（成功、失败或放弃），points为写出的点数
+    void finished(bool ok, const QString& errorMsg, qint64 points);
+
+private:
+    QString m_path;
+    Format m_format;
+    QSaveFile m_file;
+    QByteArray m_buffer;  // 每页格式化后一次写出
+    qint64 m_points = 0;
+    quint32 m_blocks = 0;
+    bool m_failed = false;
+    bool m_done = false;
+
+    void fail(const QString& errorMsg);
+};
+
+#endif //QTCLIENT_HISTORYEXPORTER_H
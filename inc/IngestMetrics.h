@@ -0,0 +1,107 @@
+#ifndef QTCLIENT_INGESTMETRICS_H
+#define QTCLIENT_INGESTMETRICS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// 耗时直方图：按2的幂分桶（纳秒），记录只有几次原子加法，可在任意线程调用
+class LatencyHistogram {
+public:
+    static constexpr int kBuckets = 40;  // 第i个桶覆盖 [2^(i-1), 2^i) 纳秒，桶0为0
+
+    void record(qint64 ns);
+    void reset();
+
+    quint64 count() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+    double meanNs() const;
+    qint64 maxNs() const {
+        return m_maxNs.load(std::memory_order_relaxed);
+    }
+    // 百分位（0~100），返回所在桶的上界，精度为2倍
+    qint64 percentileNs(double percentile) const;
+
+    QJsonObject toJson() const;
+
+private:
+    std::array<std::atomic<quint64>, kBuckets> m_buckets{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sumNs{0};
+    std::atomic<qint64> m_maxNs{0};
+};
+
+// 接收与发布路径的运行指标：各主题消息数/速率、解码耗时、界面刷新耗时、发布次数与字节数、重连次数
+// 网络线程写入，界面线程读取；计数器均为原子量，只有按主题计数需要一次无竞争的加锁
+class IngestMetrics {
+public:
+    IngestMetrics();
+
+    // 单调时钟（纳秒），各线程之间可比较
+    static qint64 nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void countMessage(const QString& topic, qint64 bytes);
+    void countPublish(qint64 bytes) {
+        m_publishCount.fetch_add(1, std::memory_order_relaxed);
+        m_publishBytes.fetch_add(static_cast<quint64>(bytes), std::memory_order_relaxed);
+    }
+    void countConnected();  // 每次连接成功调用一次
+    void countReconnect();  // 断线后每次重新发起连接调用一次
+    void countDropped() {   // 环形缓冲区已满，样本被丢弃
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    quint64 dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+    LatencyHistogram& decodeTime() {
+        return m_decodeTime;
+    }
+    LatencyHistogram& uiUpdateTime() {
+        return m_uiUpdateTime;
+    }
+    // 报文到达网络线程至样本被界面线程取出的延迟
+    LatencyHistogram& ingestLatency() {
+        return m_ingestLatency;
+    }
+
+    // 以上次调用以来的增量更新各主题的每秒消息数（由界面定时调用）
+    void sampleRates();
+
+    void reset();
+
+    // 当前全部指标的快照
+    QJsonObject toJson() const;
+
+private:
+    struct TopicCounter {
+        quint64 messages = 0;
+        quint64 bytes = 0;
+        quint64 lastMessages = 0;  // 上次sampleRates时的消息数
+        double rate = 0.0;         // 最近一个采样周期的每秒消息数
+    };
+
+    mutable QMutex m_topicMutex;
+    QHash<QString, TopicCounter> m_topics;
+    QElapsedTimer m_rateClock;  // 距上次sampleRates的时间
+    QElapsedTimer m_uptime;     // 距创建/重置的时间
+
+    std::atomic<quint64> m_publishCount{0};
+    std::atomic<quint64> m_publishBytes{0};
+    std::atomic<quint64> m_connects{0};
+    std::atomic<quint64> m_reconnects{0};
+    std::atomic<quint64> m_dropped{0};
+    LatencyHistogram m_decodeTime;
+    LatencyHistogram m_uiUpdateTime;
+    LatencyHistogram m_ingestLatency;
+};
+
+#endif //QTCLIENT_INGESTMETRICS_H
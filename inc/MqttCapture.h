@@ -0,0 +1,65 @@
+#ifndef QTCLIENT_MQTTCAPTURE_H
+#define QTCLIENT_MQTTCAPTURE_H
+
+#include <QFile>
+#include <QDataStream>
+#include <QHash>
+#include <QStringList>
+#include <QElapsedTimer>
+
+// MQTT报文录制文件格式（大端）：
+//   文件头：magic "QTCAP" + quint8 版本
+//   记录：quint8 类型
+//     类型0 主题定义：quint16 主题序号 + QByteArray 主题名（UTF-8）
+//     类型1 报文：quint16 主题序号 + quint32 距上一条报文的微秒数 + QByteArray 报文内容
+// 主题名只在第一次出现时写入一次，之后用序号引用
+
+// 一条录制的报文
+struct CapturedMessage {
+    qint64 timeUs = 0;   // 距录制开始的微秒数
+    QString topic;
+    QByteArray payload;
+};
+
+// 录制写入器：在接收线程中调用，非线程安全
+class MqttCaptureWriter {
+public:
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const {
+        return m_file.isOpen();
+    }
+    QString errorString() const {
+        return m_file.errorString();
+    }
+
+    void write(const QString& topic, const QByteArray& payload);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+    QHash<QString, quint16> m_topicIndex;
+    QElapsedTimer m_clock;
+    qint64 m_lastUs = 0;
+};
+
+// 录制读取器：按顺序读出报文
+class MqttCaptureReader {
+public:
+    bool open(const QString& path);
+    QString errorString() const {
+        return m_error;
+    }
+
+    // 读取下一条报文，文件结束或格式错误时返回false
+    bool next(CapturedMessage& message);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+    QStringList m_topics;
+    qint64 m_timeUs = 0;
+    QString m_error;
+};
+
+#endif //QTCLIENT_MQTTCAPTURE_H
@@ -0,0 +1,124 @@
+#ifndef QTCLIENT_MQTTINGESTWORKER_H
+#define QTCLIENT_MQTTINGESTWORKER_H
+
+#include <QObject>
+#include <QMqttClient>
+#include <QHash>
+#include <atomic>
+#include <functional>
+#include "DeviceState.h"
+#include "SpscRing.h"
+#include "IngestMetrics.h"
+#include "MqttCapture.h"
+
+// 解码后的采集样本：上报后的完整状态快照、本次变化的字段位与上报的字段位
+struct TelemetrySample {
+    DeviceState state;
+    quint32 changed = 0;
+    quint32 reported = 0;
+    double time = 0.0;  // 接收时间（秒，Unix时间戳）
+    qint64 arrivalNs = 0; // 接收时刻（IngestMetrics::nowNs），用于统计到界面线程的延迟
+};
+
+// MQTT接收工作对象：运行在独立的网络线程上，持有MQTT连接并在该线程完成解码
+// 采集上报通过无锁环形缓冲区交给界面线程，其余消息以排队信号转发
+class MqttIngestWorker : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int kSampleCapacity = 256;  // 网络线程到界面线程的样本缓冲区容量
+
+    // metrics可为nullptr；非空时须在工作对象销毁之前一直有效
+    explicit MqttIngestWorker(QString ip, QString topic, IngestMetrics* metrics = nullptr, QObject* parent = nullptr);
+
+    // 线程安全：当前连接状态
+    QMqttClient::ClientState state() const {
+        return m_state.load(std::memory_order_acquire);
+    }
+
+    // 网关上报主题（构造后不变）
+    const QString& topic() const {
+        return m_topic;
+    }
+
+    // 线程安全：排队到网络线程发布消息，返回本次发布的令牌
+    // qos>0时在broker确认后发出published(令牌)；qos=0时写出即视为完成
+    quint64 publish(const QString& topic, const QByteArray& payload, quint8 qos = 0);
+
+    // 线程安全：把一条报文当作从broker收到的报文送入接收路径（用于录制回放）
+    void injectMessage(const QByteArray& message, const QString& topic);
+
+    // 线程安全：开始/停止把收到的原始报文录制到文件，失败时发出captureFailed
+    void startCapture(const QString& path);
+    void stopCapture();
+
+    // 线程安全：在网络线程处理完此前排队的全部报文后，在context所在线程调用callback
+    void whenIdle(QObject* context, std::function<void()> callback);
+
+    // 界面线程调用：取出所有待处理样本，latest为最新快照，changed/reported为累计字段位
+    // 返回取出的样本数
+    int drainLatest(TelemetrySample& latest) {
+        return drain(latest, [](const TelemetrySample&) {});
+    }
+
+    // 同drainLatest，并按到达顺序对每个样本调用visit（如写入时间序列）
+    template <typename Visitor>
+    int drain(TelemetrySample& latest, Visitor&& visit) {
+        // 先清标志再取数据：之后写入的样本会重新触发samplesAvailable
+        // 两端都用读-改-写操作同一个原子量，二者必有先后：网络线程的exchange在后则看到false并重新通知，
+        // 在前则本次exchange与之同步，随后的pop一定能取到它写入的样本（普通store不能与之后的load排序）
+        m_notifyPending.exchange(false, std::memory_order_acq_rel);
+        int count = 0;
+        TelemetrySample sample;
+        while (m_samples.pop(sample)) {
+            visit(sample);
+            latest.state = sample.state;
+            latest.changed |= sample.changed;
+            latest.reported |= sample.reported;
+            latest.time = sample.time;
+            ++count;
+        }
+        return count;
+    }
+
+public slots:
+    void start();  // 在网络线程中创建MQTT客户端并连接（ip为空时为离线模式，只接受injectMessage），断线后自动重连
+    void stop();   // 在网络线程中断开连接，不再重连
+
+signals:
+    void stateChanged(QMqttClient::ClientState state);
+    // 环形缓冲区由空变为非空时发出一次，直到界面线程下一次drainLatest
+    void samplesAvailable();
+    // 非采集上报的消息（如历史数据回复）原样转发
+    void messageReceived(const QByteArray& message, const QMqttTopicName& topic);
+    // publish()返回的令牌对应的消息已完成发布
+    void published(quint64 token);
+    void captureFailed(const QString& errorMsg);
+
+private slots:
+    void onMessageReceived(const QByteArray& message, const QMqttTopicName& topic);
+    void onStateChanged(QMqttClient::ClientState state);
+    void onMessageSent(qint32 id);
+
+private:
+    // 接收路径：录制、计数、解码并交给界面线程；arrivalNs为报文到达时刻
+    void processMessage(const QByteArray& message, const QMqttTopicName& topic, qint64 arrivalNs);
+
+    QString m_ip;
+    QString m_topic;
+    QMqttClient* m_client = nullptr;
+    IngestMetrics* m_metrics;
+    bool m_stopping = false;                      // stop()之后断线不再重连（仅网络线程访问）
+    std::atomic<QMqttClient::ClientState> m_state{QMqttClient::Disconnected};
+    std::atomic<quint64> m_nextToken{1};          // 发布令牌（任意线程分配）
+    QHash<qint32, quint64> m_pendingAcks;         // 等待确认的报文id -> 令牌（仅网络线程访问）
+
+    DeviceState m_deviceState;                   // 网络线程维护的最新设备状态
+    quint32 m_pendingChanged = 0;                 // 缓冲区满时尚未送出的变化位
+    quint32 m_pendingReported = 0;                // 缓冲区满时尚未送出的上报位
+    SpscRing<TelemetrySample, kSampleCapacity> m_samples;     // 网络线程 -> 界面线程
+    std::atomic<bool> m_notifyPending{false};     // 是否已发出samplesAvailable且尚未被消费
+    MqttCaptureWriter m_capture;                  // 原始报文录制（仅网络线程访问）
+};
+
+#endif //QTCLIENT_MQTTINGESTWORKER_H
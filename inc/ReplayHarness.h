@@ -0,0 +1,44 @@
+#ifndef QTCLIENT_REPLAYHARNESS_H
+#define QTCLIENT_REPLAYHARNESS_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QElapsedTimer>
+#include "MqttCapture.h"
+#include "MqttIngestWorker.h"
+#include "IngestMetrics.h"
+
+// 录制回放：把录制文件中的报文按原始节奏（可加速）送入真实的接收路径，
+// 结束后输出吞吐量与接收延迟分位数，用于离线衡量热路径的性能变化
+class ReplayHarness : public QObject {
+    Q_OBJECT
+
+public:
+    // speed为回放倍速（1为原速），<=0表示不等待、尽可能快地送入
+    ReplayHarness(MqttIngestWorker* worker, IngestMetrics* metrics, QString path, double speed,
+                  QObject* parent = nullptr);
+
+public slots:
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private:
+    MqttIngestWorker* m_worker;
+    IngestMetrics* m_metrics;
+    QString m_path;
+    double m_speed;
+    QVector<CapturedMessage> m_messages;  // 预先读入内存，避免文件读取计入耗时
+    int m_next = 0;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+
+    void injectDue();   // 送入所有已到期的报文，并安排下一次
+    void injectChunk(); // 最快模式：送入一批，等处理完再送下一批
+    void finishWhenIdle();
+    void report();      // 输出统计结果
+};
+
+#endif //QTCLIENT_REPLAYHARNESS_H
@@ -0,0 +1,120 @@
+#ifndef QTCLIENT_ROLLUPENGINE_H
+#define QTCLIENT_ROLLUPENGINE_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+#include <array>
+#include "DeviceState.h"
+
+// 一个时间桶的聚合值
+struct RollupBucket {
+    double start = 0;      // 桶起始时间（Unix秒）
+    double open = 0;       // 桶内最早的点
+    double close = 0;      // 桶内最晚的点
+    double openTime = 0;
+    double closeTime = 0;
+    double min = 0;
+    double max = 0;
+    double sum = 0;
+    qint64 count = 0;
+
+    double mean() const {
+        return count > 0 ? sum / count : 0;
+    }
+};
+
+// 单个数据点按固定时间宽度的增量聚合：新点只更新所在的桶，不重新计算
+class RollupSeries {
+public:
+    // offsetSeconds为本地时间相对UTC的偏移，使日桶对齐本地零点
+    explicit RollupSeries(double bucketSeconds = 3600, qint64 offsetSeconds = 0);
+
+    // 追加一段按时间升序的点：按桶切分为连续区段，每段在列缓冲区上做一次归约
+    // 调用方保证同一个点不会重复加入
+    void add(const double* times, const double* values, qsizetype count);
+    void clear() {
+        m_buckets.clear();
+    }
+
+    double bucketSeconds() const {
+        return m_bucketSeconds;
+    }
+    // 时间所在桶的序号
+    qint64 indexOf(double time) const;
+    // 以桶序号为键，按时间顺序
+    const QMap<qint64, RollupBucket>& buckets() const {
+        return m_buckets;
+    }
+
+private:
+    friend class RollupEngine;  // 持久化时直接读写桶
+
+    double m_bucketSeconds;
+    qint64 m_offsetSeconds;
+    QMap<qint64, RollupBucket> m_buckets;
+};
+
+// 所有数据点的小时/日聚合，由主窗口持有，生命周期与网关连接相同
+// 数据来源有两个：实时上报的每个样本，以及从网关取回的完整历史区间
+// 每个数据点记录哪些时间段的点已计入聚合，同一时间段的历史数据不会重复计入
+// 聚合结果按网关保存到文件，长时间范围可直接按桶绘制，不需要读出原始数据
+// 非线程安全，由界面线程使用
+class RollupEngine {
+public:
+    enum Resolution {
+        Hourly,
+        Daily,
+        ResolutionCount
+    };
+
+    // 闭区间，Unix秒
+    struct Span {
+        double start;
+        double end;
+    };
+
+    RollupEngine();
+
+    // 实时样本：reported（DeviceField位）标记的字段计入各自的聚合，并延长该数据点的实时区间
+    void record(double time, const DeviceState& state, quint32 reported);
+    // 实时接收中断（断线）：之后的实时点另起一个区间，中断期间的历史数据可以补入
+    void breakLive();
+    // 从网关取回的[start, end]完整历史数据（times升序）：只计入尚未计入的时间段内的点
+    void addHistory(int key, double start, double end, const double* times, const double* values, qsizetype count);
+    // [start, end]中尚未计入聚合的时间段，按时间升序
+    QVector<Span> uncounted(int key, double start, double end) const;
+
+    const RollupSeries* series(int key, Resolution resolution) const;
+    void clear();
+
+    static double bucketSeconds(Resolution resolution) {
+        return resolution == Daily ? 86400.0 : 3600.0;
+    }
+
+    // 默认保存位置：与历史缓存同目录（每个网关一个）
+    static QString defaultPath(const QString& gatewayTopic);
+    // 读取保存的聚合，文件不存在、损坏或本地时区偏移已变化（日桶无法对齐）时返回false并保持为空
+    bool load(const QString& path);
+    bool save(const QString& path) const;
+
+private:
+    // 已计入聚合的时间段
+    struct Coverage {
+        QVector<Span> spans;    // 升序且互不重叠
+        double liveStart = -1;  // 当前实时区间，liveStart<0表示没有
+        double liveEnd = -1;
+    };
+
+    qint64 m_offsetSeconds;
+    QHash<int, std::array<RollupSeries, ResolutionCount>> m_series;
+    QHash<int, Coverage> m_coverage;
+
+    void add(int key, const double* times, const double* values, qsizetype count);
+    // 包含当前实时区间的全部已计入时间段
+    static QVector<Span> countedSpans(const Coverage& coverage);
+    static void mergeSpan(QVector<Span>& spans, Span span);
+};
+
+#endif //QTCLIENT_ROLLUPENGINE_H
@@ -0,0 +1,50 @@
+#ifndef QTCLIENT_SETPOINTLIMITER_H
+#define QTCLIENT_SETPOINTLIMITER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 设定值限速器：按key限制发布频率，最新值优先
+// 每个key同一时刻最多一条在途指令；在途期间的新值只保留最后一个，
+// 待上一条被确认（或超时）且间隔已满后再发出，保证末值必达且不会乱序
+class SetpointLimiter : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SetpointLimiter(int intervalMs = 200, int ackTimeoutMs = 2000, QObject* parent = nullptr);
+
+    // 两次发出之间的最小间隔（毫秒）
+    void setInterval(int intervalMs);
+    // 在途指令等待确认的最长时间（毫秒），超时视为已完成
+    void setAckTimeout(int ackTimeoutMs);
+
+    // 提交一个新值：可立即发出则发出，否则替换该key尚未发出的旧值
+    void submit(int key, const QString& val);
+
+    // 该key的在途指令已被确认
+    void acknowledge(int key);
+
+signals:
+    // 允许发出的值（同一key按提交顺序，且中间值可能被跳过）
+    void released(int key, const QString& val);
+
+private:
+    struct Channel {
+        QString pending;             // 尚未发出的最新值
+        bool hasPending = false;
+        bool inFlight = false;       // 已发出、等待确认
+        QElapsedTimer lastRelease;   // 上次发出至今的时间
+        QTimer* timer = nullptr;     // 间隔到期或确认超时
+    };
+
+    QHash<int, Channel> m_channels;
+    int m_intervalMs;
+    int m_ackTimeoutMs;
+
+    Channel& channel(int key);
+    void tryRelease(int key);
+};
+
+#endif //QTCLIENT_SETPOINTLIMITER_H
@@ -0,0 +1,48 @@
+#ifndef QTCLIENT_SPSCRING_H
+#define QTCLIENT_SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// 无锁单生产者/单消费者环形缓冲区：生产者与消费者各自只写一个索引
+// Capacity必须是2的幂，索引单调递增，取模用位与完成
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity必须是2的幂");
+
+public:
+    // 生产者线程调用：缓冲区已满时返回false，不覆盖未读数据
+    bool push(const T& item) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者线程调用：缓冲区为空时返回false
+    bool pop(T& item) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    // 两个索引分处不同缓存行，避免生产者与消费者互相踩缓存
+    alignas(64) std::atomic<std::size_t> m_head{0};  // 下一个写入位置（生产者独占写）
+    alignas(64) std::atomic<std::size_t> m_tail{0};  // 下一个读取位置（消费者独占写）
+    std::array<T, Capacity> m_items{};
+};
+
+#endif //QTCLIENT_SPSCRING_H
@@ -0,0 +1,28 @@
+#ifndef QTCLIENT_TELEMETRYDECODER_H
+#define QTCLIENT_TELEMETRYDECODER_H
+
+#include <QByteArrayView>
+#include "DeviceState.h"
+
+// 采集上报（type=1）流式解码器：单次扫描原始报文，不构建QJsonDocument
+class TelemetryDecoder {
+public:
+    enum Result {
+        Applied,   // 报文有效且至少更新了一个数据点
+        Ignored,   // 报文合法，但不是成功的采集上报或不含已知数据点
+        Malformed  // JSON格式错误
+    };
+
+    // 解码一条采集上报，将key 301~311、101~105直接写入state
+    // 只有在报文完整解析且type=1、result=0时才提交修改，否则state保持不变
+    // changed非空时，按DeviceField累加值确实发生变化的字段位
+    // reported非空时，按DeviceField累加本条报文中出现的字段位（无论是否变化）
+    static Result decodeReport(QByteArrayView payload, DeviceState& state, quint32* changed = nullptr,
+                               quint32* reported = nullptr);
+
+private:
+    // 按点表把单个数据点写入state并记录变化位与上报位，未知key返回false
+    static bool applyPoint(DeviceState& state, int key, QByteArrayView val, quint32& changed, quint32& reported);
+};
+
+#endif //QTCLIENT_TELEMETRYDECODER_H
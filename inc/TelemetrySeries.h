@@ -0,0 +1,81 @@
+#ifndef QTCLIENT_TELEMETRYSERIES_H
+#define QTCLIENT_TELEMETRYSERIES_H
+
+#include <QVector>
+#include <array>
+#include "DataPointRegistry.h"
+
+// 单个数据点的定长环形时间序列：时间列与数值列分开存放，写满后覆盖最旧的点
+class TelemetrySeries {
+public:
+    // 一段按时间顺序连续存放的数据（指向内部缓冲区，不拷贝）
+    struct Segment {
+        const double* time = nullptr;
+        const double* value = nullptr;
+        int count = 0;
+    };
+
+    explicit TelemetrySeries(int capacity = 4096);
+
+    void append(double time, double value);
+    void clear();
+
+    int size() const {
+        return m_size;
+    }
+    int capacity() const {
+        return static_cast<int>(m_time.size());
+    }
+    bool isEmpty() const {
+        return m_size == 0;
+    }
+
+    // 按时间顺序的两段视图：segments()[0]在前，segments()[1]在后（可能为空）
+    // 视图在下一次append/clear之前有效
+    std::array<Segment, 2> segments() const;
+
+    // 第i个点（0为最旧），不做越界检查
+    double timeAt(int i) const {
+        return m_time[physicalIndex(i)];
+    }
+    double valueAt(int i) const {
+        return m_value[physicalIndex(i)];
+    }
+    double lastTime() const {
+        return timeAt(m_size - 1);
+    }
+    double lastValue() const {
+        return valueAt(m_size - 1);
+    }
+
+private:
+    QVector<double> m_time;   // 时间列（秒，Unix时间戳）
+    QVector<double> m_value;  // 数值列
+    int m_head = 0;           // 下一个写入位置
+    int m_size = 0;           // 有效点数
+
+    int physicalIndex(int i) const {
+        const int start = m_head - m_size;
+        const int index = start + i;
+        return index < 0 ? index + capacity() : (index >= capacity() ? index - capacity() : index);
+    }
+};
+
+// 所有可上报数据点的实时时间序列，按点表下标存放
+class TelemetryStore {
+public:
+    explicit TelemetryStore(int capacityPerKey = 4096);
+
+    // 把一次上报中reported（DeviceField位）标记的字段值写入各自的序列
+    void record(double time, const DeviceState& state, quint32 reported);
+
+    // 按key取序列，未知key或只控制的数据点返回nullptr
+    const TelemetrySeries* series(int key) const;
+
+    void clear();
+
+private:
+    std::array<TelemetrySeries, DataPointRegistry::kDataPointCount> m_series;
+};
+
+#endif //QTCLIENT_TELEMETRYSERIES_H
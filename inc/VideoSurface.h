@@ -0,0 +1,40 @@
+#ifndef QTCLIENT_VIDEOSURFACE_H
+#define QTCLIENT_VIDEOSURFACE_H
+
+#include <QWidget>
+#include <QImage>
+
+// 视频显示控件：只保存最新一帧解码后的图像，在paintEvent中按比例缩放绘制到控件区域
+// 不为每帧生成QPixmap和缩放副本；播放时用最近邻缩放，暂停时才使用平滑缩放
+class VideoSurface : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit VideoSurface(QWidget* parent = nullptr);
+
+    // 设置最新一帧，图像为RGB32或ARGB32_Premultiplied时绘制不需要格式转换
+    void setFrame(const QImage& frame);
+    void clear();
+
+    void setPaused(bool paused);
+    bool isPaused() const {
+        return m_paused;
+    }
+
+    void setPlaceholderText(const QString& text);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    QImage m_frame;
+    bool m_paused = false;
+    QString m_placeholderText;
+    QRect m_frameRect;  // 上一帧绘制的区域，新帧尺寸不变时只重绘这一块
+
+    QRect targetRect(const QSize& frameSize) const;
+};
+
+#endif //QTCLIENT_VIDEOSURFACE_H
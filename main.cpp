@@ -1,10 +1,49 @@
 #include <QApplication>
 #include <QPushButton>
+#include <QCommandLineParser>
 #include "uiClass/SearchUpgrade/searchupgrade.h"
+#include "uiClass/MainWidget/mainwidget.h"
+#include "ReplayHarness.h"
+#include "HistoryBenchmark.h"
+#include "DecodeBenchmark.h"
 
 int main(int argc, char* argv[]) {
     QApplication a(argc, argv);
+
+    // 离线回放模式：Qtclient --replay <录制文件> [--speed <倍速|max>]
+    // 历史编码对比：Qtclient --bench-history <点数>
+    // 上报解码对比：Qtclient --bench-decode <录制文件>
+    // 无界面环境可加 -platform offscreen
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption replayOption("replay", "回放录制的MQTT报文并输出性能统计", "file");
+    QCommandLineOption speedOption("speed", "回放倍速，max表示尽可能快（默认1）", "speed", "1");
+    QCommandLineOption benchHistoryOption("bench-history", "对比历史数据JSON与二进制编码的体积和解码耗时", "points");
+    QCommandLineOption benchDecodeOption("bench-decode", "用录制的报文对比QJsonDocument与流式解码的耗时", "file");
+    parser.addOption(replayOption);
+    parser.addOption(speedOption);
+    parser.addOption(benchHistoryOption);
+    parser.addOption(benchDecodeOption);
+    parser.process(a);
+
+    if (parser.isSet(benchHistoryOption)) {
+        return runHistoryBenchmark(parser.value(benchHistoryOption).toInt());
+    }
+    if (parser.isSet(benchDecodeOption)) {
+        return runDecodeBenchmark(parser.value(benchDecodeOption));
+    }
+
+    if (parser.isSet(replayOption)) {
+        const QString speedText = parser.value(speedOption);
+        const double speed = speedText == "max" ? 0.0 : speedText.toDouble();
+        MainWidget mainWidget(nullptr, "", "");  // 不显示、不连接，只走真实的接收与刷新路径
+        ReplayHarness harness(mainWidget.ingestWorker(), &mainWidget.metrics(), parser.value(replayOption), speed);
+        QObject::connect(&harness, &ReplayHarness::finished, &a, &QApplication::exit);
+        QMetaObject::invokeMethod(&harness, &ReplayHarness::start, Qt::QueuedConnection);
+        return QApplication::exec();
+    }
+
     SearchUpgrade searchUpgrade;
     searchUpgrade.show();
     return QApplication::exec();
-}
\ No newline at end of file
+}
@@ -0,0 +1,63 @@
+#include "CommandBatcher.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+CommandBatcher::CommandBatcher(int windowMs, QObject* parent) : QObject(parent) {
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(windowMs);
+    connect(&m_timer, &QTimer::timeout, this, &CommandBatcher::flush);
+}
+
+void CommandBatcher::setWindow(int windowMs) {
+    m_timer.setInterval(qMax(0, windowMs));
+}
+
+void CommandBatcher::enqueue(int key, const QString& val) {
+    // 窗口内同一key后写覆盖先写，保持首次写入的位置
+    for (Command& command : m_pending) {
+        if (command.key == key) {
+            command.val = val;
+            return;
+        }
+    }
+    m_pending.append({key, val});
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+void CommandBatcher::flush() {
+    m_timer.stop();
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    QJsonObject rootJson;
+    rootJson["type"] = 2;  // 指令类型：2-控制指令
+
+    if (m_pending.size() == 1) {
+        // 单条指令保持原有的对象格式，兼容只识别单个data对象的网关
+        QJsonObject dataJson;
+        dataJson["key"] = m_pending.first().key;
+        dataJson["val"] = m_pending.first().val;
+        rootJson["data"] = dataJson;
+    } else {
+        QJsonArray dataArray;
+        for (const Command& command : std::as_const(m_pending)) {
+            QJsonObject dataJson;
+            dataJson["key"] = command.key;
+            dataJson["val"] = command.val;
+            dataArray.append(dataJson);
+        }
+        rootJson["data"] = dataArray;
+    }
+    QVector<int> keys;
+    keys.reserve(m_pending.size());
+    for (const Command& command : std::as_const(m_pending)) {
+        keys.append(command.key);
+    }
+    m_pending.clear();
+
+    emit batchReady(QJsonDocument(rootJson).toJson(QJsonDocument::Compact), keys);
+}
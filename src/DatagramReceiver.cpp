@@ -0,0 +1,129 @@
+#include "DatagramReceiver.h"
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+struct DatagramReceiver::NativeBatch {
+    std::vector<mmsghdr> messages;
+    std::vector<iovec> vectors;
+    std::vector<sockaddr_storage> addresses;
+};
+#else
+struct DatagramReceiver::NativeBatch {
+};
+#endif
+
+DatagramReceiver::DatagramReceiver(QUdpSocket* socket, int batchSize, qsizetype bufferSize, int socketBufferBytes)
+    : m_socket(socket),
+      m_batchSize(qMax(1, batchSize)),
+      m_bufferSize(qMax<qsizetype>(1, bufferSize)),
+      m_buffers(static_cast<size_t>(m_batchSize * m_bufferSize)),
+      m_datagrams(m_batchSize),
+      m_native(std::make_unique<NativeBatch>()) {
+    if (socketBufferBytes > 0) {
+        m_socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, socketBufferBytes);
+    }
+#ifdef Q_OS_LINUX
+    m_native->messages.resize(m_batchSize);
+    m_native->vectors.resize(m_batchSize);
+    m_native->addresses.resize(m_batchSize);
+#endif
+}
+
+DatagramReceiver::~DatagramReceiver() = default;
+
+int DatagramReceiver::receiveBatch() {
+    // 第一个数据报总是经过QUdpSocket读取：QUdpSocket在发出readyRead后会暂停读通知，
+    // 直到通过它读取一次才恢复，全部绕过它读取会导致之后收不到readyRead
+    int count = 0;
+    for (int attempt = 0; count == 0 && attempt < m_batchSize && m_socket->hasPendingDatagrams(); ++attempt) {
+        if (readOne(0)) {
+            count = 1;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+#ifdef Q_OS_LINUX
+    count += readNative(count);
+#else
+    while (count < m_batchSize && m_socket->hasPendingDatagrams()) {
+        if (readOne(count)) {
+            ++count;
+        }
+    }
+#endif
+    m_stats.datagrams += count;
+    ++m_stats.batches;
+    return count;
+}
+
+bool DatagramReceiver::readOne(int slot) {
+    Datagram& datagram = m_datagrams[slot];
+    const qint64 pending = m_socket->pendingDatagramSize();
+    const qint64 size = m_socket->readDatagram(buffer(slot), m_bufferSize, &datagram.sender, &datagram.senderPort);
+    if (size < 0) {
+        return false;
+    }
+    if (pending > m_bufferSize) {
+        ++m_stats.truncated;
+        return false;
+    }
+    datagram.data = buffer(slot);
+    datagram.size = size;
+    return true;
+}
+
+int DatagramReceiver::readNative(int first) {
+#ifdef Q_OS_LINUX
+    const int wanted = m_batchSize - first;
+    if (wanted <= 0) {
+        return 0;
+    }
+    // 数据直接写入预分配的缓冲区
+    NativeBatch& batch = *m_native;
+    for (int i = 0; i < wanted; ++i) {
+        batch.vectors[i].iov_base = buffer(first + i);
+        batch.vectors[i].iov_len = static_cast<size_t>(m_bufferSize);
+        batch.messages[i] = {};
+        batch.messages[i].msg_hdr.msg_iov = &batch.vectors[i];
+        batch.messages[i].msg_hdr.msg_iovlen = 1;
+        batch.messages[i].msg_hdr.msg_name = &batch.addresses[i];
+        batch.messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+    const int received = ::recvmmsg(static_cast<int>(m_socket->socketDescriptor()), batch.messages.data(),
+                                    static_cast<unsigned int>(wanted), MSG_DONTWAIT, nullptr);
+    if (received <= 0) {
+        return 0;  // EAGAIN：已读完
+    }
+    int count = 0;
+    for (int i = 0; i < received; ++i) {
+        const mmsghdr& message = batch.messages[i];
+        if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+            ++m_stats.truncated;
+            continue;
+        }
+        // 跳过被截断的数据报后，把后面的数据报前移，使有效数据报占据连续的槽
+        const int slot = first + count;
+        if (slot != first + i) {
+            std::copy_n(buffer(first + i), message.msg_len, buffer(slot));
+        }
+        const auto* address = &batch.addresses[i];
+        Datagram& datagram = m_datagrams[slot];
+        datagram.data = buffer(slot);
+        datagram.size = message.msg_len;
+        // 复用已有的QHostAddress，稳态下不再分配
+        datagram.sender.setAddress(reinterpret_cast<const sockaddr*>(address));
+        datagram.senderPort = address->ss_family == AF_INET6
+                                  ? ntohs(reinterpret_cast<const sockaddr_in6*>(address)->sin6_port)
+                                  : ntohs(reinterpret_cast<const sockaddr_in*>(address)->sin_port);
+        ++count;
+    }
+    return count;
+#else
+    Q_UNUSED(first);
+    return 0;
+#endif
+}
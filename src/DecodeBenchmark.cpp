@@ -0,0 +1,123 @@
+#include "DecodeBenchmark.h"
+#include "MqttCapture.h"
+#include "TelemetryDecoder.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QVector>
+
+namespace {
+constexpr int kRounds = 5;  // 取多轮中的最短耗时
+
+// 原来MainWidget中的解码方式：构建QJsonDocument后逐个数据点按key写入
+bool decodeWithDocument(const QByteArray& message, DeviceState& state) {
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(message, &error);
+    if (error.error != QJsonParseError::NoError) {
+        return false;
+    }
+    const QJsonObject rootObj = doc.object();
+    if (rootObj["type"].toInt() != 1 || rootObj["result"].toInt() != 0) {
+        return false;
+    }
+    const QJsonArray dataArray = rootObj["data"].toArray();
+    for (const auto& val : dataArray) {
+        const QJsonObject dataObj = val.toObject();
+        const int key = dataObj["key"].toInt();
+        const QString valStr = dataObj["val"].toString();
+        switch (key) {
+            case 301: state.ledState = (valStr == "true"); break;
+            case 302: state.buzzerState = (valStr == "true"); break;
+            case 303: state.fanState = (valStr == "true"); break;
+            case 304: state.humidity = static_cast<float>(valStr.toDouble()); break;
+            case 307: state.temperature = static_cast<float>(valStr.toDouble()); break;
+            case 310: state.infraredState = (valStr == "true"); break;
+            case 311: state.doorLockState = (valStr == "true"); break;
+            case 101: state.tvState = (valStr == "true"); break;
+            case 103: state.waterHeaterTemp = static_cast<float>(valStr.toDouble()); break;
+            case 104: state.airConditionerState = (valStr == "true"); break;
+            case 105: state.airConditionerTemp = static_cast<int>(valStr.toDouble()); break;
+            default: break;
+        }
+    }
+    return true;
+}
+
+bool sameState(const DeviceState& a, const DeviceState& b) {
+    return a.ledState == b.ledState && a.buzzerState == b.buzzerState && a.fanState == b.fanState
+        && a.doorLockState == b.doorLockState && a.tvState == b.tvState && a.infraredState == b.infraredState
+        && a.airConditionerState == b.airConditionerState && a.temperature == b.temperature
+        && a.humidity == b.humidity && a.waterHeaterTemp == b.waterHeaterTemp
+        && a.airConditionerTemp == b.airConditionerTemp;
+}
+
+// 返回多轮中最短的总耗时（纳秒）
+template <typename Decode>
+qint64 timeDecode(const QVector<QByteArray>& messages, Decode decode) {
+    qint64 best = -1;
+    for (int round = 0; round < kRounds; ++round) {
+        DeviceState state;
+        QElapsedTimer timer;
+        timer.start();
+        for (const QByteArray& message : messages) {
+            decode(message, state);
+        }
+        const qint64 elapsed = timer.nsecsElapsed();
+        best = best < 0 ? elapsed : qMin(best, elapsed);
+    }
+    return best;
+}
+}
+
+int runDecodeBenchmark(const QString& capturePath) {
+    QTextStream out(stdout);
+    MqttCaptureReader reader;
+    if (!reader.open(capturePath)) {
+        out << "无法打开录制文件: " << reader.errorString() << Qt::endl;
+        return 1;
+    }
+    QVector<QByteArray> messages;
+    CapturedMessage message;
+    while (reader.next(message)) {
+        messages.append(message.payload);
+    }
+    if (!reader.errorString().isEmpty()) {
+        out << "读取录制文件出错: " << reader.errorString() << Qt::endl;
+        return 1;
+    }
+    if (messages.isEmpty()) {
+        out << "录制文件中没有报文" << Qt::endl;
+        return 1;
+    }
+
+    // 先逐条校验两种解码得到的状态一致
+    DeviceState documentState;
+    DeviceState streamingState;
+    int mismatches = 0;
+    for (const QByteArray& payload : std::as_const(messages)) {
+        decodeWithDocument(payload, documentState);
+        TelemetryDecoder::decodeReport(payload, streamingState);
+        if (!sameState(documentState, streamingState)) {
+            ++mismatches;
+            streamingState = documentState;  // 对齐后继续比较后面的报文
+        }
+    }
+
+    const qint64 documentNs = timeDecode(messages, decodeWithDocument);
+    const qint64 streamingNs = timeDecode(messages, [](const QByteArray& payload, DeviceState& state) {
+        TelemetryDecoder::decodeReport(payload, state);
+    });
+
+    const qsizetype count = messages.size();
+    out << QString("采集上报解码对比，%1 条报文").arg(count) << Qt::endl;
+    out << QString("QJsonDocument: %1 ns/条").arg(double(documentNs) / count, 0, 'f', 1) << Qt::endl;
+    out << QString("TelemetryDecoder: %1 ns/条").arg(double(streamingNs) / count, 0, 'f', 1) << Qt::endl;
+    out << QString("速度 %1 倍").arg(double(documentNs) / qMax<qint64>(1, streamingNs), 0, 'f', 1) << Qt::endl;
+    if (mismatches > 0) {
+        out << QString("有 %1 条报文的解码结果不一致").arg(mismatches) << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "DetectionLog.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <algorithm>
+#include <utility>
+
+namespace {
+// 字段中的制表符和换行会破坏行格式，替换为空格
+QByteArray field(const QString& text) {
+    QString cleaned = text;
+    cleaned.replace('\t', ' ').replace('\n', ' ').replace('\r', ' ');
+    return cleaned.toUtf8();
+}
+}
+
+DetectionLog::DetectionLog(QString path) : m_path(std::move(path)) {
+}
+
+QString DetectionLog::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/detections/infrared.log";
+}
+
+bool DetectionLog::append(const QVector<DetectionEvent>& events) {
+    if (events.isEmpty()) {
+        return true;
+    }
+    if (!m_file.isOpen()) {
+        QDir().mkpath(QFileInfo(m_path).absolutePath());
+        m_file.setFileName(m_path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            return false;
+        }
+    }
+    QByteArray buffer;
+    for (const DetectionEvent& event : events) {
+        buffer.append(field(event.timestamp)).append('\t');
+        buffer.append(field(event.status)).append('\t');
+        buffer.append(field(event.remark)).append('\n');
+    }
+    // 每批只写一次并立即刷新，检索时能读到刚写入的事件
+    return m_file.write(buffer) == buffer.size() && m_file.flush();
+}
+
+QVector<DetectionEvent> DetectionLog::search(const QString& text, int maxResults,
+                                             const std::atomic<bool>* cancelled) const {
+    QVector<DetectionEvent> results;
+    QFile file(m_path);
+    if (maxResults <= 0 || !file.open(QIODevice::ReadOnly)) {
+        return results;
+    }
+    // 只保留最近的maxResults条：结果以环形方式写入，最后再按时间顺序排列
+    results.reserve(maxResults);
+    qsizetype next = 0;
+    while (!file.atEnd()) {
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+            return {};
+        }
+        QByteArray line = file.readLine();
+        if (line.endsWith('\n')) {
+            line.chop(1);
+        }
+        if (!text.isEmpty() && !QString::fromUtf8(line).contains(text, Qt::CaseInsensitive)) {
+            continue;
+        }
+        const QList<QByteArray> fields = line.split('\t');
+        DetectionEvent event;
+        event.timestamp = QString::fromUtf8(fields.value(0));
+        event.status = QString::fromUtf8(fields.value(1));
+        event.remark = QString::fromUtf8(fields.value(2));
+        if (results.size() < maxResults) {
+            results.append(std::move(event));
+        } else {
+            results[next] = std::move(event);
+        }
+        next = (next + 1) % maxResults;
+    }
+    if (results.size() == maxResults) {
+        std::rotate(results.begin(), results.begin() + next, results.end());
+    }
+    return results;
+}
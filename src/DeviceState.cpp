@@ -0,0 +1,20 @@
+#include "DeviceState.h"
+#include "DataPointRegistry.h"
+
+quint32 DeviceState::differences(const DeviceState& other, quint32 fields) const {
+    quint32 result = 0;
+    for (const DataPointRegistry::DataPoint& point : DataPointRegistry::kDataPoints) {
+        if ((fields & point.field) && point.differs && point.differs(*this, other)) {
+            result |= point.field;
+        }
+    }
+    return result;
+}
+
+void DeviceState::merge(const DeviceState& from, quint32 fields) {
+    for (const DataPointRegistry::DataPoint& point : DataPointRegistry::kDataPoints) {
+        if ((fields & point.field) && point.copy) {
+            point.copy(*this, from);
+        }
+    }
+}
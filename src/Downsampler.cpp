@@ -0,0 +1,122 @@
+#include "Downsampler.h"
+#include <cmath>
+
+namespace {
+void selectAll(qsizetype count, QVector<qsizetype>& out) {
+    out.resize(count);
+    for (qsizetype i = 0; i < count; ++i) {
+        out[i] = i;
+    }
+}
+}
+
+namespace Downsampler {
+void minMax(const double* times, const double* values, qsizetype count, int buckets, QVector<qsizetype>& out) {
+    out.clear();
+    if (buckets <= 0 || count <= 2 * qsizetype(buckets) + 2) {
+        selectAll(count, out);
+        return;
+    }
+    out.reserve(2 * buckets + 2);
+    const auto select = [&out](qsizetype i) {
+        if (out.isEmpty() || out.last() != i) {  // 桶内最小值与最大值是同一点时只输出一次
+            out.append(i);
+        }
+    };
+
+    const double first = times[0];
+    const double width = (times[count - 1] - first) / buckets;
+    select(0);
+    qsizetype i = 1;
+    int bucket = -1;
+    while (i < count - 1) {
+        // 当前点所在的桶，桶号只增不减，避免浮点舍入使同一个桶被处理两次
+        const int located = width > 0 ? static_cast<int>(std::floor((times[i] - first) / width)) : buckets - 1;
+        bucket = qMin(qMax(bucket + 1, located), buckets - 1);
+        // 最后一个桶延伸到末尾（width为0时所有点都落入最后一个桶）
+        const double bucketEnd = bucket == buckets - 1 ? INFINITY : first + (bucket + 1) * width;
+        qsizetype minIndex = i;
+        qsizetype maxIndex = i;
+        // 桶的首点总是计入，避免浮点舍入使times[i]恰好不小于bucketEnd时停滞
+        for (++i; i < count - 1 && times[i] < bucketEnd; ++i) {
+            if (values[i] < values[minIndex]) {
+                minIndex = i;
+            }
+            if (values[i] > values[maxIndex]) {
+                maxIndex = i;
+            }
+        }
+        select(qMin(minIndex, maxIndex));
+        select(qMax(minIndex, maxIndex));
+    }
+    select(count - 1);
+}
+
+void lttb(const double* times, const double* values, qsizetype count, int threshold, QVector<qsizetype>& out) {
+    out.clear();
+    if (threshold < 3 || count <= threshold) {
+        selectAll(count, out);
+        return;
+    }
+    out.reserve(threshold);
+
+    // 首尾之外的点分为threshold-2个桶，每桶选出与上一个选中点、下一桶均值点构成面积最大的点
+    const double every = double(count - 2) / (threshold - 2);
+    qsizetype selected = 0;
+    out.append(0);
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        const auto begin = static_cast<qsizetype>(std::floor(bucket * every)) + 1;
+        const auto end = static_cast<qsizetype>(std::floor((bucket + 1) * every)) + 1;
+
+        // 下一桶的平均点（最后一个桶以末点代替）
+        const auto nextBegin = end;
+        const auto nextEnd = qMin(static_cast<qsizetype>(std::floor((bucket + 2) * every)) + 1, count);
+        double averageTime = 0;
+        double averageValue = 0;
+        for (qsizetype j = nextBegin; j < nextEnd; ++j) {
+            averageTime += times[j];
+            averageValue += values[j];
+        }
+        const qsizetype nextCount = nextEnd - nextBegin;
+        averageTime /= nextCount;
+        averageValue /= nextCount;
+
+        const double selectedTime = times[selected];
+        const double selectedValue = values[selected];
+        double maxArea = -1;
+        qsizetype next = begin;
+        for (qsizetype j = begin; j < end; ++j) {
+            const double area = std::abs((selectedTime - averageTime) * (values[j] - selectedValue) -
+                                         (selectedTime - times[j]) * (averageValue - selectedValue));
+            if (area > maxArea) {
+                maxArea = area;
+                next = j;
+            }
+        }
+        out.append(next);
+        selected = next;
+    }
+    out.append(count - 1);
+}
+
+bool downsample(Method method, const double* times, const double* values, qsizetype count, int pixels,
+                QVector<qsizetype>& out) {
+    out.clear();
+    switch (method) {
+        case Method::MinMax:
+            if (count <= 2 * qsizetype(pixels) + 2) {
+                return false;
+            }
+            minMax(times, values, count, pixels, out);
+            return true;
+        case Method::Lttb:
+            if (count <= 2 * qsizetype(pixels)) {
+                return false;
+            }
+            lttb(times, values, count, 2 * pixels, out);
+            return true;
+        default:
+            return false;
+    }
+}
+}
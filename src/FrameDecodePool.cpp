@@ -0,0 +1,87 @@
+#include "FrameDecodePool.h"
+#include <QMutexLocker>
+#include <utility>
+
+FrameDecodePool::FrameDecodePool(int threads, QObject* parent) : QObject(parent), m_maxWorkers(qMax(1, threads)) {
+    m_pool.setObjectName("frame-decode");
+    m_pool.setMaxThreadCount(m_maxWorkers);
+}
+
+FrameDecodePool::~FrameDecodePool() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hasPending = false;
+        m_pending.clear();
+    }
+    // 解码任务访问本对象，必须在析构前结束；已排队的frameDecoded事件随对象删除而丢弃
+    m_pool.waitForDone();
+}
+
+void FrameDecodePool::submit(const QByteArray& data) {
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_hasPending) {
+            ++m_dropped;  // 还没开始解码的旧帧被新帧取代
+        }
+        m_pending = data;
+        m_hasPending = true;
+        m_pendingSequence = ++m_nextSequence;
+        if (m_workers >= m_maxWorkers) {
+            return;  // 正在运行的任务解码完当前帧后会取走这一帧
+        }
+        ++m_workers;
+    }
+    m_pool.start([this] { work(); });
+}
+
+quint64 FrameDecodePool::droppedFrames() const {
+    QMutexLocker locker(&m_mutex);
+    return m_dropped;
+}
+
+quint64 FrameDecodePool::failedFrames() const {
+    QMutexLocker locker(&m_mutex);
+    return m_failed;
+}
+
+bool FrameDecodePool::looksLikeImage(const QByteArray& data) {
+    return data.startsWith("\xFF\xD8\xFF")       // JPEG
+        || data.startsWith("\x89PNG\r\n\x1A\n")  // PNG
+        || data.startsWith("BM");                // BMP
+}
+
+void FrameDecodePool::work() {
+    for (;;) {
+        QByteArray data;
+        quint64 sequence;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_hasPending) {
+                --m_workers;
+                return;
+            }
+            data = std::exchange(m_pending, QByteArray());
+            m_hasPending = false;
+            sequence = m_pendingSequence;
+        }
+
+        QImage image;
+        if (!image.loadFromData(data)) {
+            QMutexLocker locker(&m_mutex);
+            ++m_failed;
+            continue;
+        }
+        // 转换为绘制时不需再转换的格式，格式相同时不复制
+        image = image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                              : QImage::Format_RGB32);
+
+        QMutexLocker locker(&m_mutex);
+        if (sequence <= m_lastDelivered) {
+            ++m_dropped;  // 另一个任务已经送出了更新的帧
+            continue;
+        }
+        m_lastDelivered = sequence;
+        // 持锁发出，保证排队到界面线程的顺序与sequence一致
+        emit frameDecoded(image, sequence);
+    }
+}
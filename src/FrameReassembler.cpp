@@ -0,0 +1,120 @@
+#include "FrameReassembler.h"
+#include <QtEndian>
+#include <cstring>
+#include <iterator>
+
+namespace {
+constexpr char kMagic[4] = {'I', 'R', 'F', '1'};
+// 落后超过这么多帧的编号视为设备重启后重新计数
+constexpr qint32 kRestartDistance = 1000;
+
+// 帧编号按序列号算术比较，允许回绕
+bool isNewer(quint32 a, quint32 b) {
+    return static_cast<qint32>(a - b) > 0;
+}
+}
+
+FrameReassembler::FrameReassembler(int timeoutMs, int maxPendingFrames)
+    : m_timeoutMs(timeoutMs), m_maxPendingFrames(qMax(1, maxPendingFrames)) {
+}
+
+bool FrameReassembler::push(const char* data, qsizetype size, qint64 nowMs, QByteArray& frame) {
+    if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        frame = QByteArray(data, size);  // 不分片的数据报
+        return true;
+    }
+    const auto* header = reinterpret_cast<const uchar*>(data);
+    const quint32 frameId = qFromLittleEndian<quint32>(header + 4);
+    const quint16 index = qFromLittleEndian<quint16>(header + 8);
+    const quint16 count = qFromLittleEndian<quint16>(header + 10);
+    if (count == 0 || count > kMaxFragments || index >= count) {
+        ++m_stats.malformed;
+        return false;
+    }
+
+    if (m_started && !isNewer(frameId, m_lastFinished)) {
+        if (static_cast<qint32>(m_lastFinished - frameId) < kRestartDistance) {
+            ++m_stats.lateFragments;
+            return false;
+        }
+        reset();  // 编号大幅后退：设备已重启
+    }
+
+    auto it = m_pending.find(frameId);
+    if (it == m_pending.end()) {
+        // 同时重组的帧数有上限，超出时丢弃最旧的帧
+        while (m_pending.size() >= m_maxPendingFrames) {
+            auto oldest = m_pending.begin();
+            for (auto candidate = m_pending.begin(); candidate != m_pending.end(); ++candidate) {
+                if (isNewer(oldest.key(), candidate.key())) {
+                    oldest = candidate;
+                }
+            }
+            drop(oldest);
+        }
+        PendingFrame pending;
+        pending.fragments.resize(count);
+        pending.firstSeenMs = nowMs;
+        it = m_pending.insert(frameId, pending);
+    }
+    PendingFrame& pending = it.value();
+    if (pending.fragments.size() != count) {
+        ++m_stats.malformed;  // 同一帧的分片总数不一致
+        return false;
+    }
+    QByteArray& slot = pending.fragments[index];
+    if (!slot.isNull()) {
+        ++m_stats.duplicateFragments;
+        return false;
+    }
+    slot = QByteArray(data + kHeaderSize, size - kHeaderSize);
+    if (slot.isNull()) {
+        slot = QByteArray("");  // 空分片也要与未收到区分
+    }
+    pending.bytes += slot.size();
+    if (++pending.received < count) {
+        return false;
+    }
+
+    // 收齐后按序号拼接
+    frame.clear();
+    frame.reserve(pending.bytes);
+    for (const QByteArray& fragment : std::as_const(pending.fragments)) {
+        frame.append(fragment);
+    }
+    m_pending.erase(it);
+    ++m_stats.completeFrames;
+    finish(frameId);
+
+    // 比它更早的未完成帧已经过时
+    for (auto older = m_pending.begin(); older != m_pending.end();) {
+        older = isNewer(frameId, older.key()) ? drop(older) : std::next(older);
+    }
+    return true;
+}
+
+void FrameReassembler::expire(qint64 nowMs) {
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        it = nowMs - it.value().firstSeenMs >= m_timeoutMs ? drop(it) : std::next(it);
+    }
+}
+
+void FrameReassembler::reset() {
+    m_pending.clear();
+    m_started = false;
+}
+
+void FrameReassembler::finish(quint32 frameId) {
+    if (!m_started || isNewer(frameId, m_lastFinished)) {
+        m_lastFinished = frameId;
+        m_started = true;
+    }
+}
+
+QMap<quint32, FrameReassembler::PendingFrame>::iterator FrameReassembler::drop(QMap<quint32, PendingFrame>::iterator it) {
+    const PendingFrame& pending = it.value();
+    ++m_stats.incompleteFrames;
+    m_stats.lostFragments += pending.fragments.size() - pending.received;
+    finish(it.key());
+    return m_pending.erase(it);
+}
@@ -0,0 +1,193 @@
+#include "GatewayManager.h"
+#include "TelemetryDecoder.h"
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QTimer>
+#include <utility>
+
+namespace {
+constexpr int kReconnectDelayMs = 5000;  // 断线后重连间隔
+}
+
+GatewayManager::GatewayManager(int networkThreads, QObject* parent) : QObject(parent) {
+    if (networkThreads <= 0) {
+        networkThreads = qMax(1, QThread::idealThreadCount() / 2);
+    }
+    for (int i = 0; i < networkThreads; ++i) {
+        auto* thread = new QThread(this);
+        thread->setObjectName(QString("gateway-net-%1").arg(i));
+        thread->start();
+        m_networkThreads.push_back(thread);
+    }
+    m_decodePool.setObjectName("gateway-decode");
+}
+
+GatewayManager::~GatewayManager() {
+    // 先在各自线程中断开连接，再结束网络线程
+    for (const auto& gateway : m_gateways) {
+        QMetaObject::invokeMethod(gateway->connection, &GatewayConnection::stop, Qt::BlockingQueuedConnection);
+    }
+    for (QThread* thread : m_networkThreads) {
+        thread->quit();
+        thread->wait();
+    }
+    // 网络线程已结束，可以在当前线程直接释放连接对象
+    for (const auto& gateway : m_gateways) {
+        delete gateway->connection;
+    }
+    // 解码任务持有Gateway指针，必须在释放m_gateways之前结束
+    m_decodePool.waitForDone();
+}
+
+int GatewayManager::addGateway(const QString& ip, const QString& topic) {
+    auto gateway = std::make_unique<Gateway>();
+    Gateway* raw = gateway.get();
+    int id;
+    {
+        QMutexLocker locker(&m_mutex);
+        id = static_cast<int>(m_gateways.size());
+        raw->id = id;
+        GatewaySnapshot snapshot;
+        snapshot.ip = ip;
+        snapshot.topic = topic;
+        m_snapshots.append(snapshot);
+        m_gateways.push_back(std::move(gateway));
+        m_dirty.insert(id);
+    }
+
+    // 连接按轮转分布到网络线程
+    QThread* thread = m_networkThreads[m_nextThread];
+    m_nextThread = (m_nextThread + 1) % static_cast<int>(m_networkThreads.size());
+    raw->connection = new GatewayConnection(this, raw, ip, topic);
+    raw->connection->moveToThread(thread);
+    QMetaObject::invokeMethod(raw->connection, &GatewayConnection::start, Qt::QueuedConnection);
+    return id;
+}
+
+int GatewayManager::gatewayCount() const {
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_gateways.size());
+}
+
+QVector<int> GatewayManager::takeDirty(QVector<GatewaySnapshot>& snapshots) {
+    QMutexLocker locker(&m_mutex);
+    QVector<int> ids(m_dirty.cbegin(), m_dirty.cend());
+    m_dirty.clear();
+    snapshots.clear();
+    snapshots.reserve(ids.size());
+    for (const int id : std::as_const(ids)) {
+        snapshots.append(m_snapshots[id]);
+    }
+    return ids;
+}
+
+void GatewayManager::publish(int id, const QString& topic, const QByteArray& payload) {
+    GatewayConnection* connection = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (id < 0 || id >= static_cast<int>(m_gateways.size())) {
+            return;
+        }
+        connection = m_gateways[id]->connection;
+    }
+    QMetaObject::invokeMethod(connection, [connection, topic, payload] {
+        connection->publish(topic, payload);
+    }, Qt::QueuedConnection);
+}
+
+void GatewayManager::enqueue(Gateway* gateway, const QByteArray& message) {
+    {
+        QMutexLocker locker(&gateway->queueMutex);
+        gateway->queue.append(message);
+        if (gateway->scheduled) {
+            return;  // 已有任务在处理该网关，报文会在同一任务中按顺序解码
+        }
+        gateway->scheduled = true;
+    }
+    m_decodePool.start([this, gateway] { drain(gateway); });
+}
+
+void GatewayManager::drain(Gateway* gateway) {
+    QVector<QByteArray> batch;
+    for (;;) {
+        {
+            QMutexLocker locker(&gateway->queueMutex);
+            if (gateway->queue.isEmpty()) {
+                gateway->scheduled = false;
+                return;
+            }
+            batch.swap(gateway->queue);
+        }
+
+        quint32 changed = 0;
+        quint32 reported = 0;
+        for (const QByteArray& message : std::as_const(batch)) {
+            TelemetryDecoder::decodeReport(message, gateway->state, &changed, &reported);
+        }
+        gateway->reported |= reported;
+
+        // 一批报文只提交一次快照
+        QMutexLocker locker(&m_mutex);
+        GatewaySnapshot& snapshot = m_snapshots[gateway->id];
+        snapshot.messages += batch.size();
+        if (reported != 0) {
+            snapshot.device = gateway->state;
+            snapshot.reported = gateway->reported;
+            snapshot.lastReportMs = QDateTime::currentMSecsSinceEpoch();
+        }
+        m_dirty.insert(gateway->id);
+        locker.unlock();
+        batch.clear();
+    }
+}
+
+void GatewayManager::setConnectionState(int id, QMqttClient::ClientState state) {
+    QMutexLocker locker(&m_mutex);
+    m_snapshots[id].connection = state;
+    m_dirty.insert(id);
+}
+
+GatewayConnection::GatewayConnection(GatewayManager* manager, GatewayManager::Gateway* gateway, QString ip,
+                                     QString topic)
+    : m_manager(manager), m_gateway(gateway), m_id(gateway->id), m_ip(std::move(ip)), m_topic(std::move(topic)) {
+}
+
+void GatewayConnection::start() {
+    m_client = new QMqttClient(this);
+    m_client->setHostname(m_ip);
+    m_client->setPort(1883);
+    connect(m_client, &QMqttClient::stateChanged, this, &GatewayConnection::onStateChanged);
+    connect(m_client, &QMqttClient::messageReceived, this, &GatewayConnection::onMessageReceived);
+    m_client->connectToHost();
+}
+
+void GatewayConnection::stop() {
+    m_stopping = true;
+    if (m_client) {
+        m_client->disconnectFromHost();
+    }
+}
+
+void GatewayConnection::publish(const QString& topic, const QByteArray& payload) {
+    if (m_client && m_client->state() == QMqttClient::Connected) {
+        m_client->publish(topic, payload);
+    }
+}
+
+void GatewayConnection::onStateChanged(QMqttClient::ClientState state) {
+    m_manager->setConnectionState(m_id, state);
+    if (state == QMqttClient::Connected) {
+        m_client->subscribe(m_topic);
+    } else if (state == QMqttClient::Disconnected && !m_stopping) {
+        QTimer::singleShot(kReconnectDelayMs, this, [this] {
+            if (!m_stopping && m_client->state() == QMqttClient::Disconnected) {
+                m_client->connectToHost();
+            }
+        });
+    }
+}
+
+void GatewayConnection::onMessageReceived(const QByteArray& message, const QMqttTopicName& topic) {
+    Q_UNUSED(topic)
+    m_manager->enqueue(m_gateway, message);  // 只取该网关自己的队列锁
+}
@@ -0,0 +1,276 @@
+#include "GorillaCodec.h"
+#include <bit>
+#include <cmath>
+
+namespace {
+class BitWriter {
+public:
+    explicit BitWriter(QByteArray& out) : m_out(out) {
+    }
+
+    // 写入value的低bits位，高位在前
+    void write(quint64 value, int bits) {
+        while (bits > 0) {
+            const int room = 8 - m_used;
+            const int take = qMin(room, bits);
+            const auto chunk = static_cast<quint8>((value >> (bits - take)) & ((1u << take) - 1));
+            m_byte = static_cast<quint8>(m_byte | (chunk << (room - take)));
+            m_used += take;
+            bits -= take;
+            if (m_used == 8) {
+                m_out.append(static_cast<char>(m_byte));
+                m_byte = 0;
+                m_used = 0;
+            }
+        }
+    }
+
+    void flush() {
+        if (m_used > 0) {
+            m_out.append(static_cast<char>(m_byte));
+            m_byte = 0;
+            m_used = 0;
+        }
+    }
+
+private:
+    QByteArray& m_out;
+    quint8 m_byte = 0;
+    int m_used = 0;
+};
+
+class BitReader {
+public:
+    BitReader(const quint8* data, qsizetype size) : m_data(data), m_bits(size * 8) {
+    }
+
+    // 读取bits位（不超过64），越界时返回false
+    bool read(int bits, quint64& value) {
+        if (m_position + bits > m_bits) {
+            return false;
+        }
+        value = 0;
+        while (bits > 0) {
+            const int offset = static_cast<int>(m_position & 7);
+            const int take = qMin(8 - offset, bits);
+            const quint8 byte = m_data[m_position >> 3];
+            value = (value << take) | ((byte >> (8 - offset - take)) & ((1u << take) - 1));
+            m_position += take;
+            bits -= take;
+        }
+        return true;
+    }
+
+    bool bit(bool& value) {
+        quint64 v;
+        if (!read(1, v)) {
+            return false;
+        }
+        value = v != 0;
+        return true;
+    }
+
+    qsizetype bytesConsumed() const {
+        return (m_position + 7) / 8;
+    }
+
+private:
+    const quint8* m_data;
+    qsizetype m_bits;
+    qsizetype m_position = 0;
+};
+
+// 时间二阶差分的分段编码：前缀位数、前缀、值位数
+struct DodBucket {
+    int prefixBits;
+    quint64 prefix;
+    int valueBits;
+};
+constexpr DodBucket kDodBuckets[] = {{2, 0b10, 7}, {3, 0b110, 9}, {4, 0b1110, 12}};
+
+qint64 toMs(double time) {
+    return std::llround(time * 1000.0);
+}
+}
+
+namespace GorillaCodec {
+void encode(const double* times, const double* values, qsizetype count, QByteArray& out) {
+    const auto n = static_cast<quint32>(count);
+    for (int i = 0; i < 4; ++i) {
+        out.append(static_cast<char>((n >> (8 * i)) & 0xFF));
+    }
+    if (count == 0) {
+        return;
+    }
+
+    BitWriter writer(out);
+    qint64 previousTime = toMs(times[0]);
+    qint64 previousDelta = 0;
+    quint64 previousValue = std::bit_cast<quint64>(values[0]);
+    int previousLeading = -1;  // 尚无可沿用的有效位窗口
+    int previousTrailing = 0;
+    writer.write(static_cast<quint64>(previousTime), 64);
+    writer.write(previousValue, 64);
+
+    for (qsizetype i = 1; i < count; ++i) {
+        const qint64 time = toMs(times[i]);
+        const qint64 delta = time - previousTime;
+        const qint64 dod = delta - previousDelta;
+        previousTime = time;
+        previousDelta = delta;
+        if (dod == 0) {
+            writer.write(0, 1);
+        } else {
+            bool written = false;
+            for (const DodBucket& bucket : kDodBuckets) {
+                const qint64 bias = (qint64(1) << (bucket.valueBits - 1)) - 1;  // 取值范围[-bias, bias+1]
+                if (dod >= -bias && dod <= bias + 1) {
+                    writer.write(bucket.prefix, bucket.prefixBits);
+                    writer.write(static_cast<quint64>(dod + bias), bucket.valueBits);
+                    written = true;
+                    break;
+                }
+            }
+            if (!written) {
+                writer.write(0b1111, 4);
+                writer.write(static_cast<quint64>(dod), 64);
+            }
+        }
+
+        const quint64 value = std::bit_cast<quint64>(values[i]);
+        const quint64 xorValue = value ^ previousValue;
+        previousValue = value;
+        if (xorValue == 0) {
+            writer.write(0, 1);
+            continue;
+        }
+        const int leading = qMin(std::countl_zero(xorValue), 31);  // 前导零数用5位保存
+        const int trailing = std::countr_zero(xorValue);
+        if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+            const int meaningful = 64 - previousLeading - previousTrailing;
+            writer.write(0b10, 2);
+            writer.write(xorValue >> previousTrailing, meaningful);
+        } else {
+            const int meaningful = 64 - leading - trailing;
+            writer.write(0b11, 2);
+            writer.write(static_cast<quint64>(leading), 5);
+            writer.write(static_cast<quint64>(meaningful - 1), 6);
+            writer.write(xorValue >> trailing, meaningful);
+            previousLeading = leading;
+            previousTrailing = trailing;
+        }
+    }
+    writer.flush();
+}
+
+bool decode(QByteArrayView block, QVector<double>& times, QVector<double>& values, qsizetype* consumed) {
+    if (block.size() < 4) {
+        return false;
+    }
+    const auto* data = reinterpret_cast<const quint8*>(block.data());
+    const quint32 count = data[0] | (data[1] << 8) | (data[2] << 16) | (quint32(data[3]) << 24);
+    // 第一个点128位、之后每个点至少2位，据此拒绝伪造的超大点数，避免按其预留内存
+    if (count > 0 && (block.size() - 4) * 4 < 64 + qsizetype(count) - 1) {
+        return false;
+    }
+
+    const qsizetype base = times.size();
+    times.resize(base + count);  // 按上报的点数一次预留，直接写入列缓冲区
+    values.resize(base + count);
+    double* timeOut = times.data() + base;
+    double* valueOut = values.data() + base;
+    const auto fail = [&] {
+        times.resize(base);
+        values.resize(base);
+        return false;
+    };
+
+    BitReader reader(data + 4, block.size() - 4);
+    if (count > 0) {
+        quint64 rawTime;
+        quint64 rawValue;
+        if (!reader.read(64, rawTime) || !reader.read(64, rawValue)) {
+            return fail();
+        }
+        qint64 time = static_cast<qint64>(rawTime);
+        qint64 delta = 0;
+        quint64 value = rawValue;
+        int leading = 0;
+        int trailing = 0;
+        bool haveWindow = false;
+        timeOut[0] = time / 1000.0;
+        valueOut[0] = std::bit_cast<double>(value);
+
+        for (quint32 i = 1; i < count; ++i) {
+            // 时间：数前缀中连续的1确定分段
+            int ones = 0;
+            bool bit = true;
+            while (ones < 4) {
+                if (!reader.bit(bit)) {
+                    return fail();
+                }
+                if (!bit) {
+                    break;
+                }
+                ++ones;
+            }
+            qint64 dod = 0;
+            if (ones == 4) {
+                quint64 raw;
+                if (!reader.read(64, raw)) {
+                    return fail();
+                }
+                dod = static_cast<qint64>(raw);
+            } else if (ones > 0) {
+                const DodBucket& bucket = kDodBuckets[ones - 1];
+                const qint64 bias = (qint64(1) << (bucket.valueBits - 1)) - 1;
+                quint64 raw;
+                if (!reader.read(bucket.valueBits, raw)) {
+                    return fail();
+                }
+                dod = static_cast<qint64>(raw) - bias;
+            }
+            delta += dod;
+            time += delta;
+            timeOut[i] = time / 1000.0;
+
+            // 值
+            if (!reader.bit(bit)) {
+                return fail();
+            }
+            if (bit) {
+                bool newWindow;
+                if (!reader.bit(newWindow)) {
+                    return fail();
+                }
+                if (newWindow) {
+                    quint64 lead;
+                    quint64 length;
+                    if (!reader.read(5, lead) || !reader.read(6, length)) {
+                        return fail();
+                    }
+                    const int meaningful = static_cast<int>(length) + 1;
+                    if (static_cast<int>(lead) + meaningful > 64) {
+                        return fail();
+                    }
+                    leading = static_cast<int>(lead);
+                    trailing = 64 - leading - meaningful;
+                    haveWindow = true;
+                } else if (!haveWindow) {
+                    return fail();  // 还没有可沿用的有效位窗口
+                }
+                quint64 bits;
+                if (!reader.read(64 - leading - trailing, bits)) {
+                    return fail();
+                }
+                value ^= bits << trailing;
+            }
+            valueOut[i] = std::bit_cast<double>(value);
+        }
+    }
+    if (consumed) {
+        *consumed = 4 + reader.bytesConsumed();
+    }
+    return true;
+}
+}
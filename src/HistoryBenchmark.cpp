@@ -0,0 +1,110 @@
+#include "HistoryBenchmark.h"
+#include "HistoryClient.h"
+#include "GorillaCodec.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+namespace {
+constexpr int kRounds = 5;  // 取多轮中的最短耗时
+
+QByteArray jsonReply(const QVector<double>& times, const QVector<double>& values) {
+    QJsonArray dataArray;
+    for (int i = 0; i < times.size(); ++i) {
+        QJsonObject point;
+        point["time"] = times[i];
+        point["val"] = QString::number(values[i], 'f', 1);
+        dataArray.append(point);
+    }
+    QJsonObject rootJson;
+    rootJson["type"] = 4;
+    rootJson["id"] = 1;
+    rootJson["key"] = 307;
+    rootJson["result"] = 0;
+    rootJson["data"] = dataArray;
+    return QJsonDocument(rootJson).toJson(QJsonDocument::Compact);
+}
+
+QByteArray binaryReply(const QVector<double>& times, const QVector<double>& values) {
+    QByteArray reply("QTH\x01", 4);
+    const auto appendLe32 = [&reply](quint32 value) {
+        for (int i = 0; i < 4; ++i) {
+            reply.append(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    };
+    appendLe32(1);    // id
+    appendLe32(307);  // key
+    appendLe32(0);    // result
+    reply.append('\0').append('\0');  // 无续传令牌
+    GorillaCodec::encode(times.constData(), values.constData(), times.size(), reply);
+    return reply;
+}
+
+// 返回多轮中最短的解码耗时（纳秒），解析失败时返回-1
+qint64 timeParse(const QByteArray& message, int expected) {
+    qint64 best = -1;
+    for (int round = 0; round < kRounds; ++round) {
+        QElapsedTimer timer;
+        timer.start();
+        HistoryClient::Page page;
+        const bool ok = HistoryClient::parsePage(message, page);
+        const qint64 elapsed = timer.nsecsElapsed();
+        if (!ok || page.times.size() != expected) {
+            return -1;
+        }
+        best = best < 0 ? elapsed : qMin(best, elapsed);
+    }
+    return best;
+}
+}
+
+int runHistoryBenchmark(int points) {
+    QTextStream out(stdout);
+    if (points <= 0) {
+        out << "点数必须大于0" << Qt::endl;
+        return 1;
+    }
+
+    // 模拟网关数据：1秒采样，温度保留1位小数缓慢变化
+    QVector<double> times(points);
+    QVector<double> values(points);
+    double value = 23.5;
+    const double start = 1700000000;
+    for (int i = 0; i < points; ++i) {
+        times[i] = start + i;
+        if (QRandomGenerator::global()->bounded(10) == 0) {
+            value += (QRandomGenerator::global()->bounded(3) - 1) * 0.1;
+        }
+        values[i] = QString::number(value, 'f', 1).toDouble();  // 与JSON往返后的值一致
+    }
+
+    const QByteArray json = jsonReply(times, values);
+    const QByteArray binary = binaryReply(times, values);
+    const qint64 jsonNs = timeParse(json, points);
+    const qint64 binaryNs = timeParse(binary, points);
+    if (jsonNs < 0 || binaryNs < 0) {
+        out << "解码结果不正确" << Qt::endl;
+        return 1;
+    }
+
+    const auto row = [&out, points](const char* name, qsizetype bytes, qint64 ns) {
+        out << QString("%1: %2 字节（%3 字节/点），解码 %4 ms（%5 ns/点）")
+                   .arg(name)
+                   .arg(bytes)
+                   .arg(double(bytes) / points, 0, 'f', 2)
+                   .arg(ns / 1e6, 0, 'f', 2)
+                   .arg(double(ns) / points, 0, 'f', 1)
+            << Qt::endl;
+    };
+    out << QString("历史数据编码对比，%1 个点").arg(points) << Qt::endl;
+    row("JSON", json.size(), jsonNs);
+    row("Gorilla", binary.size(), binaryNs);
+    out << QString("体积 %1 倍，解码速度 %2 倍")
+               .arg(double(json.size()) / binary.size(), 0, 'f', 1)
+               .arg(double(jsonNs) / binaryNs, 0, 'f', 1)
+        << Qt::endl;
+    return 0;
+}
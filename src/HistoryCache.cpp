@@ -0,0 +1,233 @@
+#include "HistoryCache.h"
+#include <QDir>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+bool writeDoubles(QIODevice& device, const double* data, qint64 count) {
+    const qint64 bytes = count * static_cast<qint64>(sizeof(double));
+    return bytes == 0 || device.write(reinterpret_cast<const char*>(data), bytes) == bytes;
+}
+}
+
+HistoryCache::HistoryCache(QString directory) : m_directory(std::move(directory)) {
+    QDir().mkpath(m_directory);
+}
+
+HistoryCache::~HistoryCache() {
+    for (const auto& column : std::as_const(m_columns)) {
+        unmap(*column);
+    }
+}
+
+QString HistoryCache::defaultDirectory(const QString& gatewayTopic) {
+    QString name = gatewayTopic;
+    name.replace(QRegularExpression("[^A-Za-z0-9_.-]"), "_");
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/history/" + name;
+}
+
+QString HistoryCache::path(int key, const char* suffix) const {
+    return QString("%1/%2.%3").arg(m_directory).arg(key).arg(suffix);
+}
+
+HistoryCache::Column& HistoryCache::column(int key) {
+    auto it = m_columns.find(key);
+    if (it != m_columns.end()) {
+        return **it;
+    }
+
+    auto column = std::make_shared<Column>();
+    column->timeFile.setFileName(path(key, "t"));
+    column->valueFile.setFileName(path(key, "v"));
+
+    QFile rangesFile(path(key, "ranges"));
+    if (rangesFile.open(QIODevice::ReadOnly)) {
+        const QByteArray bytes = rangesFile.readAll();
+        column->ranges.resize(static_cast<int>(bytes.size() / sizeof(Interval)));
+        memcpy(column->ranges.data(), bytes.constData(), column->ranges.size() * sizeof(Interval));
+    }
+    // 区间索引非空时数据文件必须存在，否则这些区间会被当作已缓存而不再请求
+    const bool dataMissing = !column->timeFile.exists() || !column->valueFile.exists();
+    if (!map(*column) || (dataMissing && !column->ranges.isEmpty())) {
+        column->ranges.clear();  // 数据文件损坏或缺失，区间索引作废
+        QFile::remove(path(key, "ranges"));
+    }
+    return **m_columns.insert(key, column);
+}
+
+bool HistoryCache::map(Column& column) {
+    column.times = nullptr;
+    column.values = nullptr;
+    column.count = 0;
+    if (!column.timeFile.exists() || !column.valueFile.exists()) {
+        return true;  // 尚无缓存
+    }
+    if (!column.timeFile.open(QIODevice::ReadOnly) || !column.valueFile.open(QIODevice::ReadOnly)) {
+        unmap(column);
+        return false;
+    }
+    const qint64 size = column.timeFile.size();
+    if (size != column.valueFile.size() || size % sizeof(double) != 0) {
+        unmap(column);
+        return false;
+    }
+    if (size == 0) {
+        return true;
+    }
+    column.times = reinterpret_cast<const double*>(column.timeFile.map(0, size));
+    column.values = reinterpret_cast<const double*>(column.valueFile.map(0, size));
+    if (!column.times || !column.values) {
+        unmap(column);
+        return false;
+    }
+    column.count = size / static_cast<qint64>(sizeof(double));
+    return true;
+}
+
+void HistoryCache::unmap(Column& column) {
+    // 关闭文件时自动解除映射
+    column.timeFile.close();
+    column.valueFile.close();
+    column.times = nullptr;
+    column.values = nullptr;
+    column.count = 0;
+}
+
+QVector<HistoryCache::Interval> HistoryCache::missing(int key, qint64 start, qint64 end) {
+    QVector<Interval> gaps;
+    if (start > end) {
+        return gaps;
+    }
+    qint64 cursor = start;
+    for (const Interval& range : std::as_const(column(key).ranges)) {
+        if (range.end < cursor) {
+            continue;
+        }
+        if (range.start > end) {
+            break;
+        }
+        if (range.start > cursor) {
+            gaps.append({cursor, range.start - 1});
+        }
+        cursor = range.end + 1;
+        if (cursor > end) {
+            return gaps;
+        }
+    }
+    gaps.append({cursor, end});
+    return gaps;
+}
+
+bool HistoryCache::store(int key, qint64 start, qint64 end, const QVector<double>& times, const QVector<double>& values) {
+    Column& column = this->column(key);
+
+    // 新数据只取[start, end]内的部分
+    const auto newBegin = std::lower_bound(times.cbegin(), times.cend(), static_cast<double>(start));
+    const auto newEnd = std::upper_bound(newBegin, times.cend(), static_cast<double>(end));
+    const qint64 first = newBegin - times.cbegin();
+    const qint64 added = newEnd - newBegin;
+
+    // 原有数据中被新区间覆盖的部分[lo, hi)
+    const double* oldTimes = column.times;
+    const qint64 lo = std::lower_bound(oldTimes, oldTimes + column.count, static_cast<double>(start)) - oldTimes;
+    const qint64 hi = std::upper_bound(oldTimes + lo, oldTimes + column.count, static_cast<double>(end)) - oldTimes;
+
+    bool ok;
+    if (lo == column.count) {
+        // 常见情况：查询终点后移，新数据全部追加在末尾，不重写已有数据
+        unmap(column);
+        QFile timeFile(path(key, "t"));
+        QFile valueFile(path(key, "v"));
+        ok = timeFile.open(QIODevice::WriteOnly | QIODevice::Append) &&
+             valueFile.open(QIODevice::WriteOnly | QIODevice::Append) &&
+             writeDoubles(timeFile, times.constData() + first, added) &&
+             writeDoubles(valueFile, values.constData() + first, added);
+    } else {
+        // 区间落在已有数据中间：拼接 [0, lo) + 新数据 + [hi, count) 后整体替换
+        QSaveFile timeFile(path(key, "t"));
+        QSaveFile valueFile(path(key, "v"));
+        ok = timeFile.open(QIODevice::WriteOnly) && valueFile.open(QIODevice::WriteOnly) &&
+             writeDoubles(timeFile, column.times, lo) &&
+             writeDoubles(valueFile, column.values, lo) &&
+             writeDoubles(timeFile, times.constData() + first, added) &&
+             writeDoubles(valueFile, values.constData() + first, added) &&
+             writeDoubles(timeFile, column.times + hi, column.count - hi) &&
+             writeDoubles(valueFile, column.values + hi, column.count - hi);
+        unmap(column);  // 提交前解除映射，否则部分平台无法替换文件
+        ok = ok && timeFile.commit() && valueFile.commit();
+    }
+
+    if (!ok || !map(column)) {
+        // 数据文件状态未知，丢弃该key的缓存
+        unmap(column);
+        QFile::remove(path(key, "t"));
+        QFile::remove(path(key, "v"));
+        QFile::remove(path(key, "ranges"));
+        column.ranges.clear();
+        return false;
+    }
+
+    // 合并区间索引：相邻（秒级连续）或重叠的区间合并为一个
+    QVector<Interval> ranges;
+    ranges.reserve(column.ranges.size() + 1);
+    Interval incoming{start, end};
+    bool inserted = false;
+    for (const Interval& range : std::as_const(column.ranges)) {
+        if (range.end + 1 < incoming.start) {
+            ranges.append(range);
+        } else if (incoming.end + 1 < range.start) {
+            if (!inserted) {
+                ranges.append(incoming);
+                inserted = true;
+            }
+            ranges.append(range);
+        } else {
+            incoming.start = qMin(incoming.start, range.start);
+            incoming.end = qMax(incoming.end, range.end);
+        }
+    }
+    if (!inserted) {
+        ranges.append(incoming);
+    }
+    if (!writeRanges(key, ranges)) {
+        return false;  // 数据已写入但不标记为已缓存，下次会重新请求
+    }
+    column.ranges = ranges;
+    return true;
+}
+
+bool HistoryCache::writeRanges(int key, const QVector<Interval>& ranges) const {
+    QSaveFile file(path(key, "ranges"));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    const qint64 bytes = ranges.size() * static_cast<qint64>(sizeof(Interval));
+    return file.write(reinterpret_cast<const char*>(ranges.constData()), bytes) == bytes && file.commit();
+}
+
+void HistoryCache::read(int key, qint64 start, qint64 end, QVector<double>& times, QVector<double>& values) {
+    const Column& column = this->column(key);
+    const double* begin = std::lower_bound(column.times, column.times + column.count, static_cast<double>(start));
+    const double* last = std::upper_bound(begin, column.times + column.count, static_cast<double>(end));
+    const qint64 first = begin - column.times;
+    const qint64 count = last - begin;
+    times.resize(count);
+    values.resize(count);
+    if (count > 0) {
+        memcpy(times.data(), column.times + first, count * sizeof(double));
+        memcpy(values.data(), column.values + first, count * sizeof(double));
+    }
+}
+
+void HistoryCache::clear() {
+    for (const auto& column : std::as_const(m_columns)) {
+        unmap(*column);
+    }
+    m_columns.clear();
+    QDir(m_directory).removeRecursively();
+    QDir().mkpath(m_directory);
+}
@@ -0,0 +1,221 @@
+#include "HistoryClient.h"
+#include "MqttIngestWorker.h"
+#include "GorillaCodec.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+constexpr char kBinaryMagic[] = "QTH";
+constexpr quint8 kBinaryVersion = 1;
+constexpr qsizetype kBinaryHeaderSize = 3 + 1 + 4 + 4 + 4 + 2;
+
+quint32 readLe32(const char* data) {
+    const auto* bytes = reinterpret_cast<const quint8*>(data);
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (quint32(bytes[3]) << 24);
+}
+
+bool parseBinaryPage(const QByteArray& message, HistoryClient::Page& page) {
+    const char* data = message.constData();
+    const quint16 nextLength = static_cast<quint8>(data[16]) | (static_cast<quint8>(data[17]) << 8);
+    if (message.size() < kBinaryHeaderSize + nextLength) {
+        return false;
+    }
+    page.hasId = true;
+    page.id = readLe32(data + 4);
+    page.key = static_cast<qint32>(readLe32(data + 8));
+    page.result = static_cast<qint32>(readLe32(data + 12));
+    page.next = QString::fromUtf8(data + kBinaryHeaderSize, nextLength);
+    if (page.result != 0) {
+        return true;
+    }
+    // 直接解码到列缓冲区，不经过中间对象
+    const qsizetype offset = kBinaryHeaderSize + nextLength;
+    return GorillaCodec::decode(QByteArrayView(data + offset, message.size() - offset), page.times, page.values);
+}
+
+bool parseJsonPage(const QByteArray& message, HistoryClient::Page& page) {
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(message, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        return false;
+    }
+    const QJsonObject rootObj = doc.object();
+    if (rootObj["type"].toInt() != 4) {
+        return false;
+    }
+    page.hasId = rootObj.contains("id");
+    page.id = static_cast<quint32>(rootObj["id"].toDouble());
+    page.key = rootObj["key"].toInt();
+    page.result = rootObj["result"].toInt();
+    page.next = rootObj["next"].toString();
+
+    const QJsonArray dataArray = rootObj["data"].toArray();
+    page.times.reserve(page.times.size() + dataArray.size());
+    page.values.reserve(page.values.size() + dataArray.size());
+    for (const auto& item : dataArray) {
+        const QJsonObject dataObj = item.toObject();
+        page.times.append(dataObj["time"].toDouble());
+        page.values.append(dataObj["val"].toString().toDouble());
+    }
+    return true;
+}
+
+// 网关一般按时间顺序返回，乱序时才整体排序
+void sortByTime(QVector<double>& times, QVector<double>& values) {
+    if (std::is_sorted(times.cbegin(), times.cend())) {
+        return;
+    }
+    QVector<int> order(times.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&times](int a, int b) { return times[a] < times[b]; });
+    QVector<double> sortedTimes(times.size());
+    QVector<double> sortedValues(values.size());
+    for (int i = 0; i < order.size(); ++i) {
+        sortedTimes[i] = times[order[i]];
+        sortedValues[i] = values[order[i]];
+    }
+    times.swap(sortedTimes);
+    values.swap(sortedValues);
+}
+}
+
+HistoryClient::HistoryClient(MqttIngestWorker* worker, int timeoutMs, QObject* parent)
+    : QObject(parent), m_worker(worker), m_timeoutMs(timeoutMs) {
+    connect(m_worker, &MqttIngestWorker::messageReceived, this, &HistoryClient::onMessageReceived);
+    m_timeoutTimer.setInterval(qMax(100, timeoutMs / 4));
+    connect(&m_timeoutTimer, &QTimer::timeout, this, &HistoryClient::onTimeout);
+}
+
+quint32 HistoryClient::request(int key, qint64 startTime, qint64 endTime) {
+    const quint32 id = m_nextId++;
+    if (m_nextId == 0) {
+        m_nextId = 1;  // 0保留为无效编号
+    }
+    const Request request{key, startTime, endTime, QDateTime::currentMSecsSinceEpoch()};
+    m_pending.insert(id, request);
+    if (!m_timeoutTimer.isActive()) {
+        m_timeoutTimer.start();
+    }
+    send(id, request, QString());
+    return id;
+}
+
+void HistoryClient::send(quint32 id, const Request& request, const QString& cursor) {
+    QJsonObject rootJson;
+    rootJson["type"] = 4;
+    rootJson["id"] = static_cast<double>(id);
+
+    QJsonObject dataJson;
+    dataJson["key"] = request.key;
+    dataJson["limit"] = QJsonArray{static_cast<double>(request.startTime), static_cast<double>(request.endTime)};
+    if (m_pageSize > 0) {
+        dataJson["page_size"] = m_pageSize;
+    }
+    if (!cursor.isEmpty()) {
+        dataJson["cursor"] = cursor;
+    }
+    if (m_binaryEncoding) {
+        dataJson["encoding"] = "gorilla";
+    }
+    rootJson["data"] = dataJson;
+
+    m_worker->publish(QString("up"), QJsonDocument(rootJson).toJson(QJsonDocument::Compact));
+}
+
+void HistoryClient::cancel(quint32 id) {
+    m_pending.remove(id);
+    if (m_pending.isEmpty()) {
+        m_timeoutTimer.stop();
+    }
+}
+
+void HistoryClient::cancelAll() {
+    m_pending.clear();
+    m_timeoutTimer.stop();
+}
+
+quint32 HistoryClient::matchByKey(int key) const {
+    quint32 match = 0;
+    qint64 earliest = 0;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (it->key == key && (match == 0 || it->sentMs < earliest)) {
+            match = it.key();
+            earliest = it->sentMs;
+        }
+    }
+    return match;
+}
+
+bool HistoryClient::parsePage(const QByteArray& message, Page& page) {
+    const bool binary = message.size() >= kBinaryHeaderSize &&
+                        memcmp(message.constData(), kBinaryMagic, 3) == 0 &&
+                        static_cast<quint8>(message[3]) == kBinaryVersion;
+    if (!(binary ? parseBinaryPage(message, page) : parseJsonPage(message, page))) {
+        return false;
+    }
+    sortByTime(page.times, page.values);
+    return true;
+}
+
+void HistoryClient::onMessageReceived(const QByteArray& message, const QMqttTopicName& topic) {
+    Q_UNUSED(topic)
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    Page page;
+    if (!parsePage(message, page)) {
+        return;
+    }
+    const quint32 id = page.hasId ? page.id : matchByKey(page.key);
+    const auto it = m_pending.constFind(id);
+    if (it == m_pending.cend()) {
+        return;  // 已取消、已超时或不是本客户端发出的请求
+    }
+    const Request request = it.value();
+    const bool finished = page.next.isEmpty() || page.result != 0;
+    if (finished) {
+        m_pending.erase(it);
+        if (m_pending.isEmpty()) {
+            m_timeoutTimer.stop();
+        }
+    } else {
+        m_pending[id].sentMs = QDateTime::currentMSecsSinceEpoch();
+        send(id, request, page.next);
+    }
+
+    if (page.result != 0) {
+        emit requestFailed(id, request.key, QString("网关返回错误码 %1").arg(page.result));
+        return;
+    }
+
+    double progress = 1.0;
+    if (!finished) {
+        progress = page.times.isEmpty() || request.endTime <= request.startTime
+                       ? 0.0
+                       : qBound(0.0, (page.times.last() - request.startTime) / double(request.endTime - request.startTime), 1.0);
+    }
+    emit pageReceived(id, request.key, page.times, page.values, progress, finished);
+}
+
+void HistoryClient::onTimeout() {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QVector<QPair<quint32, int>> expired;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (now - it->sentMs >= m_timeoutMs) {
+            expired.append({it.key(), it->key});
+        }
+    }
+    for (const auto& request : std::as_const(expired)) {
+        m_pending.remove(request.first);
+        emit requestFailed(request.first, request.second, "请求超时");
+    }
+    if (m_pending.isEmpty()) {
+        m_timeoutTimer.stop();
+    }
+}
@@ -0,0 +1,132 @@
+#include "HistoryExporter.h"
+#include <QDateTime>
+#include <QtEndian>
+#include <bit>
+#include <utility>
+
+namespace {
+constexpr char kColumnarMagic[] = "QTHX";
+constexpr quint8 kColumnarVersion = 1;
+constexpr qint64 kPointsOffset = 8;   // 文件头中总点数的位置
+constexpr qint64 kBlocksOffset = 16;  // 文件头中数据块数的位置
+constexpr qint64 kHeaderSize = 20;
+
+template <typename T>
+void appendLe(QByteArray& buffer, T value) {
+    const T le = qToLittleEndian(value);
+    buffer.append(reinterpret_cast<const char*>(&le), sizeof(le));
+}
+
+void appendDoubles(QByteArray& buffer, const QVector<double>& column) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    buffer.append(reinterpret_cast<const char*>(column.constData()), column.size() * qsizetype(sizeof(double)));
+#else
+    for (const double value : column) {
+        appendLe(buffer, std::bit_cast<quint64>(value));
+    }
+#endif
+}
+}
+
+HistoryExporter::HistoryExporter(QString path, Format format, QObject* parent)
+    : QObject(parent), m_path(std::move(path)), m_format(format) {
+}
+
+HistoryExporter::Format HistoryExporter::formatForPath(const QString& path) {
+    return path.endsWith(".qthx", Qt::CaseInsensitive) ? Format::Columnar : Format::Csv;
+}
+
+void HistoryExporter::open() {
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        fail(m_file.errorString());
+        return;
+    }
+    m_buffer.clear();
+    if (m_format == Format::Csv) {
+        m_buffer.append("key,timestamp,time,value\n");
+    } else {
+        m_buffer.append(kColumnarMagic, 4);
+        m_buffer.append(static_cast<char>(kColumnarVersion));
+        m_buffer.append(3, '\0');
+        appendLe<quint64>(m_buffer, 0);
+        appendLe<quint32>(m_buffer, 0);
+    }
+    if (m_file.write(m_buffer) != m_buffer.size()) {
+        fail(m_file.errorString());
+    }
+}
+
+void HistoryExporter::writePage(int key, const QVector<double>& times, const QVector<double>& values) {
+    if (m_failed || m_done || times.isEmpty()) {
+        return;
+    }
+    m_buffer.clear();
+    if (m_format == Format::Csv) {
+        const QByteArray keyText = QByteArray::number(key) + ',';
+        for (qsizetype i = 0; i < times.size(); ++i) {
+            m_buffer.append(keyText);
+            m_buffer.append(QByteArray::number(times[i], 'f', 0)).append(',');
+            m_buffer.append(QDateTime::fromSecsSinceEpoch(static_cast<qint64>(times[i])).toString(Qt::ISODate).toLatin1());
+            m_buffer.append(',').append(QByteArray::number(values[i], 'g', 10)).append('\n');
+        }
+    } else {
+        appendLe<qint32>(m_buffer, key);
+        appendLe<quint32>(m_buffer, static_cast<quint32>(times.size()));
+        appendDoubles(m_buffer, times);
+        appendDoubles(m_buffer, values);
+        ++m_blocks;
+    }
+    if (m_file.write(m_buffer) != m_buffer.size()) {
+        fail(m_file.errorString());
+        return;
+    }
+    m_points += times.size();
+}
+
+void HistoryExporter::finish() {
+    if (m_failed || m_done) {
+        return;
+    }
+    if (m_format == Format::Columnar) {
+        // 回填文件头中的总点数和数据块数
+        m_buffer.clear();
+        appendLe<quint64>(m_buffer, static_cast<quint64>(m_points));
+        const bool ok = m_file.seek(kPointsOffset) && m_file.write(m_buffer) == m_buffer.size();
+        m_buffer.clear();
+        appendLe<quint32>(m_buffer, m_blocks);
+        if (!ok || !m_file.seek(kBlocksOffset) || m_file.write(m_buffer) != m_buffer.size()) {
+            fail(m_file.errorString());
+            return;
+        }
+        static_assert(kBlocksOffset + 4 == kHeaderSize);
+    }
+    if (!m_file.commit()) {
+        fail(m_file.errorString());
+        return;
+    }
+    m_done = true;
+    emit finished(true, QString(), m_points);
+}
+
+void HistoryExporter::abort() {
+    if (m_failed || m_done) {
+        return;
+    }
+    m_file.cancelWriting();
+    m_file.commit();  // 已取消时commit只清理临时文件
+    m_done = true;
+    emit finished(false, "已取消", m_points);
+}
+
+void HistoryExporter::fail(const QString& errorMsg) {
+    if (m_failed) {
+        return;
+    }
+    m_failed = true;
+    if (m_file.isOpen()) {
+        m_file.cancelWriting();
+        m_file.commit();
+    }
+    emit finished(false, errorMsg, m_points);
+}
@@ -0,0 +1,145 @@
+#include "IngestMetrics.h"
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <bit>
+
+void LatencyHistogram::record(qint64 ns) {
+    if (ns < 0) {
+        ns = 0;
+    }
+    const int bucket = qMin(static_cast<int>(std::bit_width(static_cast<quint64>(ns))), kBuckets - 1);
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumNs.fetch_add(static_cast<quint64>(ns), std::memory_order_relaxed);
+    qint64 previous = m_maxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !m_maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNs.store(0, std::memory_order_relaxed);
+    m_maxNs.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::meanNs() const {
+    const quint64 n = count();
+    return n == 0 ? 0.0 : static_cast<double>(m_sumNs.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+qint64 LatencyHistogram::percentileNs(double percentile) const {
+    const quint64 n = count();
+    if (n == 0) {
+        return 0;
+    }
+    const auto target = static_cast<quint64>(qBound(0.0, percentile, 100.0) / 100.0 * static_cast<double>(n));
+    quint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen > target || seen == n) {
+            return i == 0 ? 0 : (qint64(1) << i) - 1;
+        }
+    }
+    return maxNs();
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    QJsonObject json;
+    json["count"] = static_cast<double>(count());
+    json["mean_ns"] = meanNs();
+    json["p50_ns"] = static_cast<double>(percentileNs(50));
+    json["p90_ns"] = static_cast<double>(percentileNs(90));
+    json["p99_ns"] = static_cast<double>(percentileNs(99));
+    json["max_ns"] = static_cast<double>(maxNs());
+    // 只输出非空桶：[桶上界(ns), 次数]
+    QJsonArray buckets;
+    for (int i = 0; i < kBuckets; ++i) {
+        const quint64 n = m_buckets[i].load(std::memory_order_relaxed);
+        if (n != 0) {
+            buckets.append(QJsonArray{static_cast<double>(i == 0 ? 0 : (qint64(1) << i) - 1), static_cast<double>(n)});
+        }
+    }
+    json["buckets"] = buckets;
+    return json;
+}
+
+IngestMetrics::IngestMetrics() {
+    m_rateClock.start();
+    m_uptime.start();
+}
+
+void IngestMetrics::countMessage(const QString& topic, qint64 bytes) {
+    QMutexLocker locker(&m_topicMutex);
+    TopicCounter& counter = m_topics[topic];
+    ++counter.messages;
+    counter.bytes += static_cast<quint64>(bytes);
+}
+
+void IngestMetrics::countConnected() {
+    m_connects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IngestMetrics::countReconnect() {
+    m_reconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IngestMetrics::sampleRates() {
+    const double seconds = m_rateClock.restart() / 1000.0;
+    QMutexLocker locker(&m_topicMutex);
+    for (TopicCounter& counter : m_topics) {
+        counter.rate = seconds > 0 ? (counter.messages - counter.lastMessages) / seconds : 0.0;
+        counter.lastMessages = counter.messages;
+    }
+}
+
+void IngestMetrics::reset() {
+    {
+        QMutexLocker locker(&m_topicMutex);
+        m_topics.clear();
+    }
+    m_publishCount.store(0, std::memory_order_relaxed);
+    m_publishBytes.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_connects.store(0, std::memory_order_relaxed);
+    m_reconnects.store(0, std::memory_order_relaxed);
+    m_decodeTime.reset();
+    m_uiUpdateTime.reset();
+    m_ingestLatency.reset();
+    m_rateClock.restart();
+    m_uptime.restart();
+}
+
+QJsonObject IngestMetrics::toJson() const {
+    QJsonObject json;
+    json["uptime_s"] = m_uptime.elapsed() / 1000.0;
+
+    QJsonObject topics;
+    {
+        QMutexLocker locker(&m_topicMutex);
+        for (auto it = m_topics.cbegin(); it != m_topics.cend(); ++it) {
+            QJsonObject topic;
+            topic["messages"] = static_cast<double>(it->messages);
+            topic["bytes"] = static_cast<double>(it->bytes);
+            topic["messages_per_s"] = it->rate;
+            topics[it.key()] = topic;
+        }
+    }
+    json["topics"] = topics;
+
+    json["decode_time"] = m_decodeTime.toJson();
+    json["ui_update_time"] = m_uiUpdateTime.toJson();
+    json["ingest_latency"] = m_ingestLatency.toJson();
+    json["dropped_samples"] = static_cast<double>(dropped());
+
+    QJsonObject publish;
+    publish["count"] = static_cast<double>(m_publishCount.load(std::memory_order_relaxed));
+    publish["bytes"] = static_cast<double>(m_publishBytes.load(std::memory_order_relaxed));
+    json["publish"] = publish;
+
+    json["connects"] = static_cast<double>(m_connects.load(std::memory_order_relaxed));
+    json["reconnects"] = static_cast<double>(m_reconnects.load(std::memory_order_relaxed));
+    return json;
+}
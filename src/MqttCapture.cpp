@@ -0,0 +1,104 @@
+#include "MqttCapture.h"
+#include <cstring>
+
+namespace {
+constexpr char kMagic[] = "QTCAP";
+constexpr quint8 kVersion = 1;
+constexpr quint8 kTopicRecord = 0;
+constexpr quint8 kMessageRecord = 1;
+}
+
+bool MqttCaptureWriter::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.writeRawData(kMagic, sizeof(kMagic) - 1);
+    m_stream << kVersion;
+    m_topicIndex.clear();
+    m_lastUs = 0;
+    m_clock.start();
+    return true;
+}
+
+void MqttCaptureWriter::close() {
+    if (m_file.isOpen()) {
+        m_stream.setDevice(nullptr);
+        m_file.close();
+    }
+}
+
+void MqttCaptureWriter::write(const QString& topic, const QByteArray& payload) {
+    if (!m_file.isOpen()) {
+        return;
+    }
+    auto it = m_topicIndex.constFind(topic);
+    if (it == m_topicIndex.constEnd()) {
+        const auto index = static_cast<quint16>(m_topicIndex.size());
+        it = m_topicIndex.insert(topic, index);
+        m_stream << kTopicRecord << index << topic.toUtf8();
+    }
+    const qint64 nowUs = m_clock.nsecsElapsed() / 1000;
+    const auto deltaUs = static_cast<quint32>(qMin<qint64>(nowUs - m_lastUs, 0xFFFFFFFF));
+    m_lastUs = nowUs;
+    m_stream << kMessageRecord << it.value() << deltaUs << payload;
+}
+
+bool MqttCaptureReader::open(const QString& path) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    char magic[sizeof(kMagic) - 1];
+    quint8 version = 0;
+    if (m_stream.readRawData(magic, sizeof(magic)) != sizeof(magic) ||
+        memcmp(magic, kMagic, sizeof(magic)) != 0) {
+        m_error = "不是有效的录制文件";
+        return false;
+    }
+    m_stream >> version;
+    if (version != kVersion) {
+        m_error = QString("不支持的录制文件版本: %1").arg(version);
+        return false;
+    }
+    m_topics.clear();
+    m_timeUs = 0;
+    return true;
+}
+
+bool MqttCaptureReader::next(CapturedMessage& message) {
+    while (!m_stream.atEnd()) {
+        quint8 type = 0;
+        quint16 index = 0;
+        m_stream >> type >> index;
+        if (type == kTopicRecord) {
+            QByteArray name;
+            m_stream >> name;
+            if (index != m_topics.size()) {
+                break;  // 主题序号必须连续
+            }
+            m_topics.append(QString::fromUtf8(name));
+            continue;
+        }
+        if (type != kMessageRecord || index >= m_topics.size()) {
+            break;
+        }
+        quint32 deltaUs = 0;
+        m_stream >> deltaUs >> message.payload;
+        if (m_stream.status() != QDataStream::Ok) {
+            break;
+        }
+        m_timeUs += deltaUs;
+        message.timeUs = m_timeUs;
+        message.topic = m_topics.at(index);
+        return true;
+    }
+    if (m_stream.status() != QDataStream::Ok || !m_stream.atEnd()) {
+        m_error = "录制文件已损坏";
+    }
+    return false;
+}
@@ -0,0 +1,165 @@
+#include "MqttIngestWorker.h"
+#include "TelemetryDecoder.h"
+#include <utility>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTimer>
+
+namespace {
+constexpr int kReconnectDelayMs = 5000;  // 断线后重连间隔
+}
+
+MqttIngestWorker::MqttIngestWorker(QString ip, QString topic, IngestMetrics* metrics, QObject* parent)
+    : QObject(parent), m_ip(std::move(ip)), m_topic(std::move(topic)), m_metrics(metrics) {
+}
+
+void MqttIngestWorker::start() {
+    // 客户端在网络线程中创建，其套接字与信号都归属该线程
+    m_client = new QMqttClient(this);
+    m_client->setHostname(m_ip);
+    m_client->setPort(1883);
+
+    connect(m_client, &QMqttClient::stateChanged, this, &MqttIngestWorker::onStateChanged);
+    connect(m_client, &QMqttClient::messageReceived, this, &MqttIngestWorker::onMessageReceived);
+    connect(m_client, &QMqttClient::messageSent, this, &MqttIngestWorker::onMessageSent);
+
+    if (!m_ip.isEmpty()) {
+        m_client->connectToHost();
+    }
+}
+
+void MqttIngestWorker::stop() {
+    m_stopping = true;
+    m_capture.close();
+    if (m_client) {
+        m_client->disconnectFromHost();
+    }
+}
+
+void MqttIngestWorker::injectMessage(const QByteArray& message, const QString& topic) {
+    // 到达时刻取调用时刻，排队等待网络线程的时间也计入延迟
+    const qint64 arrivalNs = IngestMetrics::nowNs();
+    QMetaObject::invokeMethod(this, [this, message, topic, arrivalNs] {
+        processMessage(message, QMqttTopicName(topic), arrivalNs);
+    }, Qt::QueuedConnection);
+}
+
+void MqttIngestWorker::startCapture(const QString& path) {
+    QMetaObject::invokeMethod(this, [this, path] {
+        if (!m_capture.open(path)) {
+            emit captureFailed(m_capture.errorString());
+        }
+    }, Qt::QueuedConnection);
+}
+
+void MqttIngestWorker::stopCapture() {
+    QMetaObject::invokeMethod(this, [this] {
+        m_capture.close();
+    }, Qt::QueuedConnection);
+}
+
+void MqttIngestWorker::whenIdle(QObject* context, std::function<void()> callback) {
+    // 网络线程按顺序处理事件：执行到这里时此前排队的报文都已处理完毕
+    QMetaObject::invokeMethod(this, [context, callback = std::move(callback)] {
+        QMetaObject::invokeMethod(context, callback, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+quint64 MqttIngestWorker::publish(const QString& topic, const QByteArray& payload, quint8 qos) {
+    const quint64 token = m_nextToken.fetch_add(1, std::memory_order_relaxed);
+    // 客户端只能在所属线程中使用，调用方可能在任意线程
+    QMetaObject::invokeMethod(this, [this, topic, payload, qos, token] {
+        if (!m_client || m_client->state() != QMqttClient::Connected) {
+            return;  // 未连接：不发送也不确认，由调用方自行超时
+        }
+        const qint32 id = m_client->publish(topic, payload, qos);
+        if (id >= 0 && m_metrics) {
+            m_metrics->countPublish(payload.size());
+        }
+        if (id > 0 && qos > 0) {
+            m_pendingAcks.insert(id, token);
+        } else if (id >= 0) {
+            emit published(token);
+        }
+    }, Qt::QueuedConnection);
+    return token;
+}
+
+void MqttIngestWorker::onMessageSent(qint32 id) {
+    const auto it = m_pendingAcks.constFind(id);
+    if (it == m_pendingAcks.constEnd()) {
+        return;
+    }
+    const quint64 token = it.value();
+    m_pendingAcks.erase(it);
+    emit published(token);
+}
+
+void MqttIngestWorker::onStateChanged(QMqttClient::ClientState state) {
+    m_state.store(state, std::memory_order_release);
+    if (state == QMqttClient::Disconnected) {
+        m_pendingAcks.clear();  // 连接断开后旧报文id失效
+    }
+    if (state == QMqttClient::Connected) {
+        if (m_metrics) {
+            m_metrics->countConnected();
+        }
+        m_client->subscribe(m_topic);
+    } else if (state == QMqttClient::Disconnected && !m_stopping && !m_ip.isEmpty()) {
+        QTimer::singleShot(kReconnectDelayMs, this, [this] {
+            if (!m_stopping && m_client->state() == QMqttClient::Disconnected) {
+                if (m_metrics) {
+                    m_metrics->countReconnect();
+                }
+                m_client->connectToHost();
+            }
+        });
+    }
+    emit stateChanged(state);
+}
+
+void MqttIngestWorker::onMessageReceived(const QByteArray& message, const QMqttTopicName& topic) {
+    processMessage(message, topic, IngestMetrics::nowNs());
+}
+
+void MqttIngestWorker::processMessage(const QByteArray& message, const QMqttTopicName& topic, qint64 arrivalNs) {
+    if (m_capture.isOpen()) {
+        m_capture.write(topic.name(), message);
+    }
+
+    quint32 changed = 0;
+    quint32 reported = 0;
+    QElapsedTimer decodeTimer;
+    if (m_metrics) {
+        m_metrics->countMessage(topic.name(), message.size());
+        decodeTimer.start();
+    }
+    const TelemetryDecoder::Result result = TelemetryDecoder::decodeReport(message, m_deviceState, &changed, &reported);
+    if (m_metrics) {
+        m_metrics->decodeTime().record(decodeTimer.nsecsElapsed());
+    }
+    if (result != TelemetryDecoder::Applied) {
+        // 不是采集上报，交给界面线程的其他订阅者（如历史数据窗口）
+        emit messageReceived(message, topic);
+        return;
+    }
+
+    changed |= m_pendingChanged;
+    reported |= m_pendingReported;
+    // 快照总是完整状态，缓冲区满时只需保留变化位，下次连同新快照一起送出
+    // （该样本本身被丢弃，时间序列中缺少这一点）
+    const double now = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+    if (!m_samples.push(TelemetrySample{m_deviceState, changed, reported, now, arrivalNs})) {
+        m_pendingChanged = changed;
+        m_pendingReported = reported;
+        if (m_metrics) {
+            m_metrics->countDropped();
+        }
+        return;
+    }
+    m_pendingChanged = 0;
+    m_pendingReported = 0;
+    if (!m_notifyPending.exchange(true, std::memory_order_acq_rel)) {
+        emit samplesAvailable();
+    }
+}
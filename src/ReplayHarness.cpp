@@ -0,0 +1,115 @@
+#include "ReplayHarness.h"
+#include <QTextStream>
+#include <utility>
+
+namespace {
+// 最快模式每批送入的报文数：不超过样本缓冲区容量的一半，界面线程取完一批之前缓冲区不会满
+constexpr int kMaxChunk = MqttIngestWorker::kSampleCapacity / 2;
+}
+
+ReplayHarness::ReplayHarness(MqttIngestWorker* worker, IngestMetrics* metrics, QString path, double speed,
+                             QObject* parent)
+    : QObject(parent), m_worker(worker), m_metrics(metrics), m_path(std::move(path)), m_speed(speed) {
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &ReplayHarness::injectDue);
+}
+
+void ReplayHarness::start() {
+    QTextStream out(stdout);
+    MqttCaptureReader reader;
+    if (!reader.open(m_path)) {
+        out << "无法打开录制文件: " << reader.errorString() << Qt::endl;
+        emit finished(1);
+        return;
+    }
+    CapturedMessage message;
+    while (reader.next(message)) {
+        m_messages.append(message);
+    }
+    if (!reader.errorString().isEmpty()) {
+        out << "读取录制文件出错: " << reader.errorString() << Qt::endl;
+        emit finished(1);
+        return;
+    }
+    if (m_messages.isEmpty()) {
+        out << "录制文件中没有报文" << Qt::endl;
+        emit finished(1);
+        return;
+    }
+
+    out << QString("回放 %1 条报文，倍速: %2").arg(m_messages.size())
+               .arg(m_speed > 0 ? QString::number(m_speed) : QString("最快")) << Qt::endl;
+    m_metrics->reset();
+    m_next = 0;
+    m_clock.start();
+    if (m_speed <= 0) {
+        injectChunk();
+    } else {
+        injectDue();
+    }
+}
+
+void ReplayHarness::injectDue() {
+    const qint64 baseUs = m_messages.first().timeUs;
+    const double replayUs = m_clock.nsecsElapsed() / 1000.0 * m_speed;
+    while (m_next < m_messages.size() && m_messages[m_next].timeUs - baseUs <= replayUs) {
+        m_worker->injectMessage(m_messages[m_next].payload, m_messages[m_next].topic);
+        ++m_next;
+    }
+    if (m_next < m_messages.size()) {
+        const double waitUs = (m_messages[m_next].timeUs - baseUs - replayUs) / m_speed;
+        m_timer.start(static_cast<int>(waitUs / 1000.0));
+        return;
+    }
+    finishWhenIdle();
+}
+
+void ReplayHarness::injectChunk() {
+    // 按缓冲区的背压分批送入：网络线程处理完这一批后，whenIdle的回调排在samplesAvailable之后，
+    // 回调执行时界面线程已取完这一批样本，衡量的是不丢样本时的最大可持续吞吐量
+    const int end = qMin<int>(m_messages.size(), m_next + kMaxChunk);
+    for (; m_next < end; ++m_next) {
+        m_worker->injectMessage(m_messages[m_next].payload, m_messages[m_next].topic);
+    }
+    if (m_next < m_messages.size()) {
+        m_worker->whenIdle(this, [this] { injectChunk(); });
+        return;
+    }
+    finishWhenIdle();
+}
+
+void ReplayHarness::finishWhenIdle() {
+    // 全部送入后，等网络线程处理完、界面线程取完样本再统计
+    m_worker->whenIdle(this, [this] {
+        report();
+        emit finished(0);
+    });
+}
+
+void ReplayHarness::report() {
+    const double seconds = m_clock.nsecsElapsed() / 1e9;
+    const double capturedSeconds = (m_messages.last().timeUs - m_messages.first().timeUs) / 1e6;
+    LatencyHistogram& latency = m_metrics->ingestLatency();
+    LatencyHistogram& decode = m_metrics->decodeTime();
+    LatencyHistogram& uiUpdate = m_metrics->uiUpdateTime();
+    const auto us = [](qint64 ns) { return QString::number(ns / 1000.0, 'f', 1); };
+
+    QTextStream out(stdout);
+    out << QString("报文数: %1，录制时长: %2 s，回放耗时: %3 s")
+               .arg(m_messages.size()).arg(capturedSeconds, 0, 'f', 3).arg(seconds, 0, 'f', 3) << Qt::endl;
+    // 丢弃的样本没有走完接收路径，不计入吞吐量
+    const quint64 dropped = m_metrics->dropped();
+    const double delivered = static_cast<double>(m_messages.size()) - static_cast<double>(dropped);
+    out << QString("吞吐量: %1 条/秒%2%3")
+               .arg(delivered / qMax(seconds, 1e-9), 0, 'f', 0)
+               .arg(m_speed <= 0 ? "（最大可持续速率）" : "")
+               .arg(dropped > 0 ? QString("，不含丢弃的 %1 条").arg(dropped) : QString()) << Qt::endl;
+    out << QString("接收延迟(µs): p50 %1，p90 %2，p99 %3，最大 %4（%5 个样本）")
+               .arg(us(latency.percentileNs(50)), us(latency.percentileNs(90)),
+                    us(latency.percentileNs(99)), us(latency.maxNs()))
+               .arg(latency.count()) << Qt::endl;
+    out << QString("解码耗时(µs): 平均 %1，p99 %2").arg(us(static_cast<qint64>(decode.meanNs())),
+                                                    us(decode.percentileNs(99))) << Qt::endl;
+    out << QString("界面刷新: %1 次，p99 %2 µs").arg(uiUpdate.count()).arg(us(uiUpdate.percentileNs(99))) << Qt::endl;
+    out << QString("丢弃样本: %1").arg(dropped) << Qt::endl;
+}
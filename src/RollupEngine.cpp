@@ -0,0 +1,344 @@
+#include "RollupEngine.h"
+#include "DataPointRegistry.h"
+#include "HistoryCache.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+// 聚合文件格式（QDataStream，大端）：
+//   文件头：magic "QTRLP" + quint8 版本 + qint64 本地时区偏移（秒）
+//   quint32 数据点数，每个数据点：qint32 key，按Resolution顺序每种分辨率
+//     quint32 桶数 + 每桶 qint64 桶序号、9个字段（count为qint64，其余为double）
+//   quint32 数据点数，每个数据点：qint32 key + quint32 时间段数 + 每段两个double
+constexpr char kMagic[] = "QTRLP";
+constexpr quint8 kVersion = 1;
+
+// 区段归约：分开的简单循环便于编译器向量化
+double reduceMin(const double* values, qsizetype count) {
+    double result = values[0];
+    for (qsizetype i = 1; i < count; ++i) {
+        result = values[i] < result ? values[i] : result;
+    }
+    return result;
+}
+
+double reduceMax(const double* values, qsizetype count) {
+    double result = values[0];
+    for (qsizetype i = 1; i < count; ++i) {
+        result = values[i] > result ? values[i] : result;
+    }
+    return result;
+}
+
+double reduceSum(const double* values, qsizetype count) {
+    // 四路累加，打断加法的依赖链
+    double sums[4] = {0, 0, 0, 0};
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sums[0] += values[i];
+        sums[1] += values[i + 1];
+        sums[2] += values[i + 2];
+        sums[3] += values[i + 3];
+    }
+    for (; i < count; ++i) {
+        sums[0] += values[i];
+    }
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+}
+
+RollupSeries::RollupSeries(double bucketSeconds, qint64 offsetSeconds)
+    : m_bucketSeconds(bucketSeconds), m_offsetSeconds(offsetSeconds) {
+}
+
+qint64 RollupSeries::indexOf(double time) const {
+    return static_cast<qint64>(std::floor((time + m_offsetSeconds) / m_bucketSeconds));
+}
+
+void RollupSeries::add(const double* times, const double* values, qsizetype count) {
+    qsizetype i = 0;
+    while (i < count) {
+        const qint64 index = indexOf(times[i]);
+        const double bucketStart = index * m_bucketSeconds - m_offsetSeconds;
+        const double bucketEnd = bucketStart + m_bucketSeconds;
+        const qsizetype end = std::lower_bound(times + i, times + count, bucketEnd) - times;
+        const qsizetype n = qMax<qsizetype>(1, end - i);  // 浮点舍入时至少前进一个点
+
+        const double runMin = reduceMin(values + i, n);
+        const double runMax = reduceMax(values + i, n);
+        const double runSum = reduceSum(values + i, n);
+        const double firstTime = times[i];
+        const double lastTime = times[i + n - 1];
+
+        auto it = m_buckets.find(index);
+        if (it == m_buckets.end()) {
+            RollupBucket bucket;
+            bucket.start = bucketStart;
+            bucket.open = values[i];
+            bucket.openTime = firstTime;
+            bucket.close = values[i + n - 1];
+            bucket.closeTime = lastTime;
+            bucket.min = runMin;
+            bucket.max = runMax;
+            bucket.sum = runSum;
+            bucket.count = n;
+            m_buckets.insert(index, bucket);
+        } else {
+            // 补缺口的数据可能落在已有点之前，开收盘按时间比较
+            RollupBucket& bucket = it.value();
+            if (firstTime < bucket.openTime) {
+                bucket.open = values[i];
+                bucket.openTime = firstTime;
+            }
+            if (lastTime >= bucket.closeTime) {
+                bucket.close = values[i + n - 1];
+                bucket.closeTime = lastTime;
+            }
+            bucket.min = qMin(bucket.min, runMin);
+            bucket.max = qMax(bucket.max, runMax);
+            bucket.sum += runSum;
+            bucket.count += n;
+        }
+        i += n;
+    }
+}
+
+RollupEngine::RollupEngine() : m_offsetSeconds(QDateTime::currentDateTime().offsetFromUtc()) {
+}
+
+void RollupEngine::add(int key, const double* times, const double* values, qsizetype count) {
+    if (count <= 0) {
+        return;
+    }
+    auto it = m_series.find(key);
+    if (it == m_series.end()) {
+        it = m_series.insert(key, {RollupSeries(bucketSeconds(Hourly), m_offsetSeconds),
+                                   RollupSeries(bucketSeconds(Daily), m_offsetSeconds)});
+    }
+    for (RollupSeries& series : it.value()) {
+        series.add(times, values, count);
+    }
+}
+
+void RollupEngine::record(double time, const DeviceState& state, quint32 reported) {
+    for (const DataPointRegistry::DataPoint& point : DataPointRegistry::kDataPoints) {
+        if (!(reported & point.field) || !point.read) {
+            continue;
+        }
+        const double value = point.read(state);
+        add(point.key, &time, &value, 1);
+        Coverage& coverage = m_coverage[point.key];
+        if (coverage.liveStart < 0) {
+            coverage.liveStart = time;
+        }
+        coverage.liveEnd = time;
+    }
+}
+
+void RollupEngine::breakLive() {
+    for (Coverage& coverage : m_coverage) {
+        if (coverage.liveStart >= 0) {
+            mergeSpan(coverage.spans, {coverage.liveStart, coverage.liveEnd});
+            coverage.liveStart = -1;
+            coverage.liveEnd = -1;
+        }
+    }
+}
+
+void RollupEngine::addHistory(int key, double start, double end, const double* times, const double* values,
+                              qsizetype count) {
+    Coverage& coverage = m_coverage[key];
+    const QVector<Span> counted = countedSpans(coverage);
+
+    // 点和已计入的时间段都按时间升序，一次遍历切出未计入的连续区段
+    qsizetype i = std::lower_bound(times, times + count, start) - times;
+    const qsizetype last = std::upper_bound(times + i, times + count, end) - times;
+    qsizetype span = 0;
+    while (i < last) {
+        while (span < counted.size() && counted[span].end < times[i]) {
+            ++span;
+        }
+        if (span < counted.size() && counted[span].start <= times[i]) {
+            i = std::upper_bound(times + i, times + last, counted[span].end) - times;  // 已计入，跳过
+            continue;
+        }
+        const double stop = span < counted.size() ? counted[span].start : std::numeric_limits<double>::infinity();
+        const qsizetype runEnd = std::lower_bound(times + i, times + last, stop) - times;
+        add(key, times + i, values + i, runEnd - i);
+        i = runEnd;
+    }
+    mergeSpan(coverage.spans, {start, end});
+}
+
+QVector<RollupEngine::Span> RollupEngine::uncounted(int key, double start, double end) const {
+    QVector<Span> result;
+    const auto it = m_coverage.constFind(key);
+    double cursor = start;
+    if (it != m_coverage.cend()) {
+        for (const Span& span : countedSpans(it.value())) {
+            if (span.end < cursor) {
+                continue;
+            }
+            if (span.start > end) {
+                break;
+            }
+            if (span.start > cursor) {
+                result.append({cursor, span.start});
+            }
+            cursor = span.end;
+        }
+    }
+    if (cursor < end) {
+        result.append({cursor, end});
+    }
+    return result;
+}
+
+const RollupSeries* RollupEngine::series(int key, Resolution resolution) const {
+    const auto it = m_series.constFind(key);
+    return it == m_series.cend() ? nullptr : &it.value()[resolution];
+}
+
+void RollupEngine::clear() {
+    m_series.clear();
+    m_coverage.clear();
+}
+
+QVector<RollupEngine::Span> RollupEngine::countedSpans(const Coverage& coverage) {
+    QVector<Span> spans = coverage.spans;
+    if (coverage.liveStart >= 0) {
+        mergeSpan(spans, {coverage.liveStart, coverage.liveEnd});
+    }
+    return spans;
+}
+
+void RollupEngine::mergeSpan(QVector<Span>& spans, Span span) {
+    // 与重叠或相接的时间段合并为一个
+    QVector<Span> merged;
+    merged.reserve(spans.size() + 1);
+    bool inserted = false;
+    for (const Span& existing : std::as_const(spans)) {
+        if (existing.end < span.start) {
+            merged.append(existing);
+        } else if (span.end < existing.start) {
+            if (!inserted) {
+                merged.append(span);
+                inserted = true;
+            }
+            merged.append(existing);
+        } else {
+            span.start = qMin(span.start, existing.start);
+            span.end = qMax(span.end, existing.end);
+        }
+    }
+    if (!inserted) {
+        merged.append(span);
+    }
+    spans = std::move(merged);
+}
+
+QString RollupEngine::defaultPath(const QString& gatewayTopic) {
+    return HistoryCache::defaultDirectory(gatewayTopic) + "/rollups.dat";
+}
+
+bool RollupEngine::load(const QString& path) {
+    clear();
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    char magic[sizeof(kMagic) - 1];
+    quint8 version = 0;
+    qint64 offsetSeconds = 0;
+    if (in.readRawData(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, kMagic, sizeof(magic)) != 0) {
+        return false;
+    }
+    in >> version >> offsetSeconds;
+    if (version != kVersion || offsetSeconds != m_offsetSeconds) {
+        return false;
+    }
+
+    quint32 keyCount = 0;
+    in >> keyCount;
+    for (quint32 k = 0; k < keyCount && in.status() == QDataStream::Ok; ++k) {
+        qint32 key = 0;
+        in >> key;
+        std::array<RollupSeries, ResolutionCount> series = {RollupSeries(bucketSeconds(Hourly), m_offsetSeconds),
+                                                            RollupSeries(bucketSeconds(Daily), m_offsetSeconds)};
+        for (RollupSeries& resolution : series) {
+            quint32 bucketCount = 0;
+            in >> bucketCount;
+            for (quint32 b = 0; b < bucketCount && in.status() == QDataStream::Ok; ++b) {
+                qint64 index = 0;
+                RollupBucket bucket;
+                in >> index >> bucket.start >> bucket.open >> bucket.close >> bucket.openTime >> bucket.closeTime
+                   >> bucket.min >> bucket.max >> bucket.sum >> bucket.count;
+                resolution.m_buckets.insert(index, bucket);
+            }
+        }
+        m_series.insert(key, series);
+    }
+
+    in >> keyCount;
+    for (quint32 k = 0; k < keyCount && in.status() == QDataStream::Ok; ++k) {
+        qint32 key = 0;
+        quint32 spanCount = 0;
+        in >> key >> spanCount;
+        Coverage& coverage = m_coverage[key];
+        for (quint32 s = 0; s < spanCount && in.status() == QDataStream::Ok; ++s) {
+            Span span{};
+            in >> span.start >> span.end;
+            coverage.spans.append(span);
+        }
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        clear();  // 文件损坏，聚合与已计入的时间段必须一致，整体丢弃
+        return false;
+    }
+    return true;
+}
+
+bool RollupEngine::save(const QString& path) const {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream out(&file);
+    out.writeRawData(kMagic, sizeof(kMagic) - 1);
+    out << kVersion << m_offsetSeconds;
+
+    out << static_cast<quint32>(m_series.size());
+    for (auto it = m_series.cbegin(); it != m_series.cend(); ++it) {
+        out << static_cast<qint32>(it.key());
+        for (const RollupSeries& resolution : it.value()) {
+            out << static_cast<quint32>(resolution.m_buckets.size());
+            for (auto bucket = resolution.m_buckets.cbegin(); bucket != resolution.m_buckets.cend(); ++bucket) {
+                const RollupBucket& b = bucket.value();
+                out << bucket.key() << b.start << b.open << b.close << b.openTime << b.closeTime
+                    << b.min << b.max << b.sum << b.count;
+            }
+        }
+    }
+
+    // 当前实时区间一并保存为已计入，下次启动时实时区间另起
+    out << static_cast<quint32>(m_coverage.size());
+    for (auto it = m_coverage.cbegin(); it != m_coverage.cend(); ++it) {
+        const QVector<Span> spans = countedSpans(it.value());
+        out << static_cast<qint32>(it.key()) << static_cast<quint32>(spans.size());
+        for (const Span& span : spans) {
+            out << span.start << span.end;
+        }
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
@@ -0,0 +1,70 @@
+#include "SetpointLimiter.h"
+
+SetpointLimiter::SetpointLimiter(int intervalMs, int ackTimeoutMs, QObject* parent)
+    : QObject(parent), m_intervalMs(intervalMs), m_ackTimeoutMs(ackTimeoutMs) {
+}
+
+void SetpointLimiter::setInterval(int intervalMs) {
+    m_intervalMs = qMax(0, intervalMs);
+}
+
+void SetpointLimiter::setAckTimeout(int ackTimeoutMs) {
+    m_ackTimeoutMs = qMax(0, ackTimeoutMs);
+}
+
+SetpointLimiter::Channel& SetpointLimiter::channel(int key) {
+    auto it = m_channels.find(key);
+    if (it == m_channels.end()) {
+        it = m_channels.insert(key, Channel());
+        it->timer = new QTimer(this);
+        it->timer->setSingleShot(true);
+        connect(it->timer, &QTimer::timeout, this, [this, key] {
+            Channel& ch = m_channels[key];
+            ch.inFlight = false;  // 确认超时：不再等待，避免末值被永久挂起
+            tryRelease(key);
+        });
+    }
+    return *it;
+}
+
+void SetpointLimiter::submit(int key, const QString& val) {
+    Channel& ch = channel(key);
+    ch.pending = val;  // 新值覆盖尚未发出的旧值
+    ch.hasPending = true;
+    tryRelease(key);
+}
+
+void SetpointLimiter::acknowledge(int key) {
+    auto it = m_channels.find(key);
+    if (it == m_channels.end() || !it->inFlight) {
+        return;
+    }
+    it->inFlight = false;
+    it->timer->stop();
+    tryRelease(key);
+}
+
+void SetpointLimiter::tryRelease(int key) {
+    Channel& ch = m_channels[key];
+    if (!ch.hasPending || ch.inFlight) {
+        return;  // 无待发值，或等待确认/超时后再调用
+    }
+    if (ch.lastRelease.isValid()) {
+        const qint64 remaining = m_intervalMs - ch.lastRelease.elapsed();
+        if (remaining > 0) {
+            // 间隔未满：到期后发出尾值
+            if (!ch.timer->isActive()) {
+                ch.timer->start(static_cast<int>(remaining));
+            }
+            return;
+        }
+    }
+
+    const QString val = ch.pending;
+    ch.pending.clear();
+    ch.hasPending = false;
+    ch.inFlight = true;
+    ch.lastRelease.restart();
+    ch.timer->start(m_ackTimeoutMs);
+    emit released(key, val);
+}
@@ -0,0 +1,236 @@
+#include "TelemetryDecoder.h"
+#include "DataPointRegistry.h"
+
+namespace {
+
+// 轻量JSON游标：只做词法扫描，字符串以原始字节视图返回（不做转义还原）
+class JsonCursor {
+public:
+    explicit JsonCursor(QByteArrayView text) : p(text.data()), end(text.data() + text.size()) {}
+
+    // 跳过空白后若下一个字符为c则消费并返回true
+    bool consume(char c) {
+        skipWhitespace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skipWhitespace();
+        return p < end && *p == c;
+    }
+
+    // 读取字符串，out指向引号内的原始内容
+    bool readString(QByteArrayView& out) {
+        if (!consume('"')) {
+            return false;
+        }
+        const char* begin = p;
+        while (p < end && *p != '"') {
+            if (*p == '\\') {
+                ++p;  // 跳过被转义的字符
+                if (p >= end) {
+                    return false;
+                }
+            }
+            ++p;
+        }
+        if (p >= end) {
+            return false;
+        }
+        out = QByteArrayView(begin, p - begin);
+        ++p;  // 跳过结束引号
+        return true;
+    }
+
+    // 读取标量值：字符串返回引号内内容，数字/true/false/null返回字面文本
+    bool readScalar(QByteArrayView& out) {
+        skipWhitespace();
+        if (p >= end) {
+            return false;
+        }
+        if (*p == '"') {
+            return readString(out);
+        }
+        if (*p == '{' || *p == '[') {
+            return false;
+        }
+        const char* begin = p;
+        while (p < end && *p != ',' && *p != '}' && *p != ']' && !isWhitespace(*p)) {
+            ++p;
+        }
+        out = QByteArrayView(begin, p - begin);
+        return !out.isEmpty();
+    }
+
+    // 跳过任意一个值（含嵌套对象/数组）
+    bool skipValue() {
+        skipWhitespace();
+        if (p >= end) {
+            return false;
+        }
+        if (*p != '{' && *p != '[') {
+            QByteArrayView ignored;
+            return readScalar(ignored);
+        }
+        int depth = 0;
+        while (p < end) {
+            const char c = *p;
+            if (c == '"') {
+                QByteArrayView ignored;
+                if (!readString(ignored)) {
+                    return false;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    ++p;
+                    return true;
+                }
+            }
+            ++p;
+        }
+        return false;
+    }
+
+private:
+    const char* p;
+    const char* end;
+
+    static bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    void skipWhitespace() {
+        while (p < end && isWhitespace(*p)) {
+            ++p;
+        }
+    }
+};
+
+// 解码单个数据点对象 {"key":..., "val":...}，成员顺序任意
+bool decodeDataPoint(JsonCursor& cursor, int& key, QByteArrayView& val) {
+    key = 0;
+    val = QByteArrayView();
+    if (!cursor.consume('{')) {
+        return false;
+    }
+    if (cursor.consume('}')) {
+        return true;
+    }
+    do {
+        QByteArrayView name;
+        if (!cursor.readString(name) || !cursor.consume(':')) {
+            return false;
+        }
+        if (name == "key") {
+            QByteArrayView keyText;
+            if (!cursor.readScalar(keyText)) {
+                return false;
+            }
+            key = keyText.toInt();
+        } else if (name == "val") {
+            if (!cursor.readScalar(val)) {
+                return false;
+            }
+        } else if (!cursor.skipValue()) {
+            return false;
+        }
+    } while (cursor.consume(','));
+    return cursor.consume('}');
+}
+
+} // namespace
+
+TelemetryDecoder::Result TelemetryDecoder::decodeReport(QByteArrayView payload, DeviceState& state, quint32* changed,
+                                                       quint32* reported) {
+    JsonCursor cursor(payload);
+    // 先写入副本：type/result可能出现在data之后，校验通过后再提交
+    DeviceState pending = state;
+    int type = 0;
+    int result = 0;
+    int applied = 0;
+    quint32 pendingChanged = 0;
+    quint32 pendingReported = 0;
+
+    if (!cursor.consume('{')) {
+        return Malformed;
+    }
+    if (!cursor.consume('}')) {
+        do {
+            QByteArrayView name;
+            if (!cursor.readString(name) || !cursor.consume(':')) {
+                return Malformed;
+            }
+            if (name == "type" || name == "result") {
+                QByteArrayView text;
+                if (!cursor.readScalar(text)) {
+                    return Malformed;
+                }
+                (name == "type" ? type : result) = text.toInt();
+            } else if (name == "data" && cursor.peek('[')) {
+                cursor.consume('[');
+                if (!cursor.consume(']')) {
+                    do {
+                        if (!cursor.peek('{')) {
+                            // 非对象元素直接跳过
+                            if (!cursor.skipValue()) {
+                                return Malformed;
+                            }
+                            continue;
+                        }
+                        int key;
+                        QByteArrayView val;
+                        if (!decodeDataPoint(cursor, key, val)) {
+                            return Malformed;
+                        }
+                        if (applyPoint(pending, key, val, pendingChanged, pendingReported)) {
+                            ++applied;
+                        }
+                    } while (cursor.consume(','));
+                    if (!cursor.consume(']')) {
+                        return Malformed;
+                    }
+                }
+            } else if (!cursor.skipValue()) {
+                return Malformed;
+            }
+        } while (cursor.consume(','));
+        if (!cursor.consume('}')) {
+            return Malformed;
+        }
+    }
+
+    // 只处理采集回复指令（type=1）且成功返回（result=0）的消息
+    if (type != 1 || result != 0 || applied == 0) {
+        return Ignored;
+    }
+    state = pending;
+    if (changed) {
+        *changed |= pendingChanged;
+    }
+    if (reported) {
+        *reported |= pendingReported;
+    }
+    return Applied;
+}
+
+bool TelemetryDecoder::applyPoint(DeviceState& state, int key, QByteArrayView val, quint32& changed,
+                                  quint32& reported) {
+    // 点表稠密索引分发，无字符串查找、无分配
+    const DataPointRegistry::DataPoint* point = DataPointRegistry::find(key);
+    if (!point || !point->assign || !DataPointRegistry::canReport(point->direction)) {
+        return false;
+    }
+    if (point->assign(state, val)) {
+        changed |= point->field;
+    }
+    reported |= point->field;
+    return true;
+}
@@ -0,0 +1,67 @@
+#include "TelemetrySeries.h"
+
+TelemetrySeries::TelemetrySeries(int capacity) {
+    // 一次性分配，运行中不再扩容
+    m_time.resize(qMax(1, capacity));
+    m_value.resize(qMax(1, capacity));
+}
+
+void TelemetrySeries::append(double time, double value) {
+    m_time[m_head] = time;
+    m_value[m_head] = value;
+    m_head = (m_head + 1) % capacity();
+    if (m_size < capacity()) {
+        ++m_size;
+    }
+}
+
+void TelemetrySeries::clear() {
+    m_head = 0;
+    m_size = 0;
+}
+
+std::array<TelemetrySeries::Segment, 2> TelemetrySeries::segments() const {
+    std::array<Segment, 2> result;
+    if (m_size == 0) {
+        return result;
+    }
+    const int start = physicalIndex(0);
+    const int firstCount = qMin(m_size, capacity() - start);
+    result[0] = {m_time.constData() + start, m_value.constData() + start, firstCount};
+    if (firstCount < m_size) {
+        // 数据绕回缓冲区开头
+        result[1] = {m_time.constData(), m_value.constData(), m_size - firstCount};
+    }
+    return result;
+}
+
+TelemetryStore::TelemetryStore(int capacityPerKey) {
+    for (int i = 0; i < DataPointRegistry::kDataPointCount; ++i) {
+        // 只控制的数据点不会有上报值，不占用缓冲区
+        const bool reported = DataPointRegistry::canReport(DataPointRegistry::kDataPoints[i].direction);
+        m_series[i] = TelemetrySeries(reported ? capacityPerKey : 1);
+    }
+}
+
+void TelemetryStore::record(double time, const DeviceState& state, quint32 reported) {
+    for (int i = 0; i < DataPointRegistry::kDataPointCount; ++i) {
+        const DataPointRegistry::DataPoint& point = DataPointRegistry::kDataPoints[i];
+        if ((reported & point.field) && point.read) {
+            m_series[i].append(time, point.read(state));
+        }
+    }
+}
+
+const TelemetrySeries* TelemetryStore::series(int key) const {
+    const int index = DataPointRegistry::indexOf(key);
+    if (index < 0 || !DataPointRegistry::canReport(DataPointRegistry::kDataPoints[index].direction)) {
+        return nullptr;
+    }
+    return &m_series[index];
+}
+
+void TelemetryStore::clear() {
+    for (TelemetrySeries& s : m_series) {
+        s.clear();
+    }
+}
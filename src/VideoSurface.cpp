@@ -0,0 +1,86 @@
+#include "VideoSurface.h"
+#include <QPainter>
+#include <QPaintEvent>
+
+namespace {
+const QColor kBackground("#1c1c1c");
+const QColor kBorder("#4a5668");
+const QColor kPlaceholder("#7f8c8d");
+constexpr int kBorderWidth = 2;
+}
+
+VideoSurface::VideoSurface(QWidget* parent) : QWidget(parent) {
+    // 每次重绘都完整覆盖控件区域，不需要Qt预先填充背景
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void VideoSurface::setFrame(const QImage& frame) {
+    const bool sameSize = !m_frame.isNull() && m_frame.size() == frame.size();
+    m_frame = frame;
+    if (sameSize) {
+        update(m_frameRect);  // 尺寸不变时新帧正好覆盖上一帧
+    } else {
+        update();
+    }
+}
+
+void VideoSurface::clear() {
+    m_frame = QImage();
+    update();
+}
+
+void VideoSurface::setPaused(bool paused) {
+    if (m_paused == paused) {
+        return;
+    }
+    m_paused = paused;
+    update();  // 暂停后按平滑缩放重绘当前帧
+}
+
+void VideoSurface::setPlaceholderText(const QString& text) {
+    m_placeholderText = text;
+    update();
+}
+
+QSize VideoSurface::sizeHint() const {
+    return {640, 480};
+}
+
+QRect VideoSurface::targetRect(const QSize& frameSize) const {
+    // 保持宽高比，居中放在边框内
+    const QRect area = rect().adjusted(kBorderWidth, kBorderWidth, -kBorderWidth, -kBorderWidth);
+    const QSize size = frameSize.scaled(area.size(), Qt::KeepAspectRatio);
+    QRect target(QPoint(), size);
+    target.moveCenter(area.center());
+    return target;
+}
+
+void VideoSurface::paintEvent(QPaintEvent* event) {
+    QPainter painter(this);
+    if (!m_frame.isNull()) {
+        m_frameRect = targetRect(m_frame.size());
+        if (m_frameRect.contains(event->rect())) {
+            // 只有图像区域需要重绘：不画边框；带透明通道的帧会与上一帧混合，先用背景色覆盖图像区域
+            if (m_frame.hasAlphaChannel()) {
+                painter.fillRect(m_frameRect, kBackground);
+            }
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, m_paused);
+            painter.drawImage(m_frameRect, m_frame);
+            return;
+        }
+    }
+
+    painter.fillRect(rect(), kBackground);
+    painter.setPen(QPen(kBorder, kBorderWidth));
+    painter.drawRect(rect().adjusted(kBorderWidth / 2, kBorderWidth / 2, -kBorderWidth / 2, -kBorderWidth / 2));
+    if (m_frame.isNull()) {
+        QFont font = painter.font();
+        font.setPixelSize(16);
+        painter.setFont(font);
+        painter.setPen(kPlaceholder);
+        painter.drawText(rect(), Qt::AlignCenter, m_placeholderText);
+        return;
+    }
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, m_paused);
+    painter.drawImage(m_frameRect, m_frame);
+}
@@ -0,0 +1,99 @@
+#include "diagnostics.h"
+#include "ui_diagnostics.h"
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QJsonDocument>
+#include <QHeaderView>
+#include <QDateTime>
+
+Diagnostics::Diagnostics(IngestMetrics* metrics, QWidget* parent) :
+    QDialog(parent),
+    ui(new Ui::Diagnostics),
+    metrics(metrics),
+    refreshTimer(new QTimer(this)) {
+    ui->setupUi(this);
+
+    ui->tableMetrics->setColumnCount(2);
+    ui->tableMetrics->setHorizontalHeaderLabels({"指标", "值"});
+    ui->tableMetrics->horizontalHeader()->setStretchLastSection(true);
+    ui->tableMetrics->verticalHeader()->setVisible(false);
+    ui->tableMetrics->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    connect(ui->btnExport, &QPushButton::clicked, this, &Diagnostics::onExportClicked);
+    connect(ui->btnReset, &QPushButton::clicked, this, &Diagnostics::onResetClicked);
+    connect(refreshTimer, &QTimer::timeout, this, &Diagnostics::refresh);
+
+    metrics->sampleRates();  // 以打开窗口的时刻作为第一个采样点
+    refresh();
+    refreshTimer->start(1000);
+}
+
+Diagnostics::~Diagnostics() {
+    delete ui;
+}
+
+void Diagnostics::refresh() {
+    metrics->sampleRates();
+    const QJsonObject json = metrics->toJson();
+
+    ui->tableMetrics->setRowCount(0);
+    addRow("运行时间", QString("%1 s").arg(json["uptime_s"].toDouble(), 0, 'f', 1));
+
+    const QJsonObject topics = json["topics"].toObject();
+    for (auto it = topics.begin(); it != topics.end(); ++it) {
+        const QJsonObject topic = it.value().toObject();
+        addRow(QString("主题 %1").arg(it.key()),
+               QString("%1 条/秒，共 %2 条，%3 字节")
+                   .arg(topic["messages_per_s"].toDouble(), 0, 'f', 1)
+                   .arg(topic["messages"].toDouble(), 0, 'f', 0)
+                   .arg(topic["bytes"].toDouble(), 0, 'f', 0));
+    }
+
+    addHistogramRows("解码耗时", json["decode_time"].toObject());
+    addHistogramRows("界面刷新耗时", json["ui_update_time"].toObject());
+    addHistogramRows("接收延迟", json["ingest_latency"].toObject());
+    addRow("丢弃样本", QString::number(json["dropped_samples"].toDouble(), 'f', 0));
+
+    const QJsonObject publish = json["publish"].toObject();
+    addRow("发布", QString("%1 条，%2 字节")
+                     .arg(publish["count"].toDouble(), 0, 'f', 0)
+                     .arg(publish["bytes"].toDouble(), 0, 'f', 0));
+    addRow("MQTT重连", QString::number(json["reconnects"].toDouble(), 'f', 0));
+}
+
+void Diagnostics::addRow(const QString& name, const QString& value) {
+    const int row = ui->tableMetrics->rowCount();
+    ui->tableMetrics->insertRow(row);
+    ui->tableMetrics->setItem(row, 0, new QTableWidgetItem(name));
+    ui->tableMetrics->setItem(row, 1, new QTableWidgetItem(value));
+}
+
+void Diagnostics::addHistogramRows(const QString& name, const QJsonObject& histogram) {
+    // 直方图以微秒显示
+    const auto us = [&histogram](const char* field) {
+        return QString::number(histogram[field].toDouble() / 1000.0, 'f', 1);
+    };
+    addRow(name, QString("%1 次，平均 %2 µs，p50 %3 µs，p99 %4 µs，最大 %5 µs")
+                     .arg(histogram["count"].toDouble(), 0, 'f', 0)
+                     .arg(us("mean_ns"), us("p50_ns"), us("p99_ns"), us("max_ns")));
+}
+
+void Diagnostics::onExportClicked() {
+    const QString defaultName = QString("metrics-%1.json")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    const QString path = QFileDialog::getSaveFileName(this, "导出诊断数据", defaultName, "JSON (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::warning(this, "错误", QString("无法写入文件: %1").arg(file.errorString()));
+        return;
+    }
+    file.write(QJsonDocument(metrics->toJson()).toJson());
+}
+
+void Diagnostics::onResetClicked() {
+    metrics->reset();
+    refresh();
+}
@@ -0,0 +1,36 @@
+#ifndef QTCLIENT_DIAGNOSTICS_H
+#define QTCLIENT_DIAGNOSTICS_H
+
+#include <QDialog>
+#include <QTimer>
+#include "IngestMetrics.h"
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+    class Diagnostics;
+}
+QT_END_NAMESPACE
+
+// 运行诊断窗口：每秒刷新接收/发布指标，可导出为JSON
+class Diagnostics : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit Diagnostics(IngestMetrics* metrics, QWidget* parent = nullptr);
+    ~Diagnostics() override;
+
+private slots:
+    void refresh();          // 采样速率并刷新表格
+    void onExportClicked();  // 导出JSON
+    void onResetClicked();   // 清零指标
+
+private:
+    Ui::Diagnostics* ui;
+    IngestMetrics* metrics;
+    QTimer* refreshTimer;
+
+    void addRow(const QString& name, const QString& value);
+    void addHistogramRows(const QString& name, const QJsonObject& histogram);
+};
+
+#endif //QTCLIENT_DIAGNOSTICS_H
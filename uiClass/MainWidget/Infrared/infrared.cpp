@@ -4,39 +4,154 @@
 #include <QDateTime>
 #include <QBuffer>
 #include <QHeaderView>
+#include <QTableView>
+#include <QVBoxLayout>
+#include <utility>
+
+namespace {
+constexpr int kReceiveBatch = 32;                    // 每次系统调用最多读取的数据报数
+constexpr qsizetype kMaxDatagramSize = 65536;        // UDP数据报的最大长度
+constexpr int kSocketBufferBytes = 4 * 1024 * 1024;  // 内核接收缓冲区
+constexpr int kRecordCapacity = 1000;                // 表格中保留的检测记录数
+constexpr int kRecordTickMs = 100;                   // 检测记录批量插入的周期
+constexpr int kSearchLimit = 1000;                   // 检索最多显示的记录数
+}
+
+DetectionEventModel::DetectionEventModel(int capacity, DetectionLog* log, QObject* parent)
+    : QAbstractTableModel(parent), ring(qMax(1, capacity)), log(log) {
+}
+
+int DetectionEventModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : count;
+}
+
+int DetectionEventModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant DetectionEventModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= count || role != Qt::DisplayRole) {
+        return {};
+    }
+    const DetectionEvent& event = at(index.row());
+    switch (index.column()) {
+        case ColumnTimestamp:
+            return event.timestamp;
+        case ColumnStatus:
+            return event.status;
+        case ColumnRemark:
+            return event.remark;
+        default:
+            return {};
+    }
+}
+
+QVariant DetectionEventModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    static const char* const headers[ColumnCount] = {"时间戳", "检测状态", "备注"};
+    return section >= 0 && section < ColumnCount ? QString(headers[section]) : QVariant();
+}
+
+void DetectionEventModel::append(DetectionEvent event) {
+    pending.append(std::move(event));
+}
+
+int DetectionEventModel::flush() {
+    if (pending.isEmpty()) {
+        return 0;
+    }
+    if (log) {
+        log->append(pending);  // 整批写入日志，移出表格的事件仍可检索
+    }
+    const int capacity = static_cast<int>(ring.size());
+    // 一批超过容量时，前面的事件不进入表格，只在日志中
+    const int skipped = qMax(0, static_cast<int>(pending.size()) - capacity);
+    const int incoming = static_cast<int>(pending.size()) - skipped;
+
+    // 先移除放不下的最早几行，再在末尾一次插入整批
+    const int evicted = qMax(0, count + incoming - capacity);
+    if (evicted > 0) {
+        beginRemoveRows(QModelIndex(), 0, evicted - 1);
+        head = (head + evicted) % capacity;
+        count -= evicted;
+        endRemoveRows();
+    }
+    beginInsertRows(QModelIndex(), count, count + incoming - 1);
+    for (int i = skipped; i < pending.size(); ++i) {
+        ring[(head + count) % capacity] = std::move(pending[i]);
+        ++count;
+    }
+    endInsertRows();
+    pending.clear();
+    return incoming;
+}
+
+void DetectionEventModel::setEvents(const QVector<DetectionEvent>& events) {
+    beginResetModel();
+    const int capacity = static_cast<int>(ring.size());
+    const int skipped = qMax(0, static_cast<int>(events.size()) - capacity);
+    head = 0;
+    count = 0;
+    for (int i = skipped; i < events.size(); ++i) {
+        ring[count++] = events[i];
+    }
+    pending.clear();
+    endResetModel();
+}
+
+void DetectionEventModel::clear() {
+    flush();  // 排队中的事件也要写入日志
+    beginResetModel();
+    head = 0;
+    count = 0;
+    endResetModel();
+}
 
 Infrared::Infrared(QWidget* parent) :
     QDialog(parent),
     ui(new Ui::Infrared),
     udpSocket(nullptr),
     frameRateTimer(new QTimer(this)),
+    decodePool(new FrameDecodePool(2, this)),
     frameCount(0),
-    udpPort(7777) {  // 默认UDP端口
+    motionCount(0),
+    udpPort(7777),  // 默认UDP端口
+    detectionLog(DetectionLog::defaultPath()),
+    recordModel(new DetectionEventModel(kRecordCapacity, &detectionLog, this)),
+    recordTimer(new QTimer(this)) {
 
     ui->setupUi(this);
 
     // 设置窗口标题
     setWindowTitle("红外检测监控");
+    ui->videoSurface->setPlaceholderText("视频流显示区域");
 
-    // 初始化表格
-    QStringList headers;
-    headers << "时间戳" << "检测状态" << "备注";
-    ui->tableWidget->setColumnCount(3);
-    ui->tableWidget->setHorizontalHeaderLabels(headers);
-    ui->tableWidget->horizontalHeader()->setStretchLastSection(true);
-    ui->tableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
+    // 初始化表格：只显示最近的记录，每行高度相同，视图不必逐行计算
+    ui->tableView->setModel(recordModel);
+    ui->tableView->horizontalHeader()->setStretchLastSection(true);
+    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    searchPool.setObjectName("detection-search");
+    searchPool.setMaxThreadCount(1);
 
     // 连接信号槽
     connect(ui->btnClearAll, &QPushButton::clicked, this, &Infrared::onClearRecords);
+    connect(ui->btnSearch, &QPushButton::clicked, this, &Infrared::onSearchRecords);
+    connect(ui->lineEditSearch, &QLineEdit::returnPressed, this, &Infrared::onSearchRecords);
+    connect(recordTimer, &QTimer::timeout, this, &Infrared::onRecordTick);
     connect(ui->btnStartStream, &QPushButton::clicked, this, &Infrared::onStartStream);
     connect(ui->btnStopStream, &QPushButton::clicked, this, &Infrared::onStopStream);
     connect(frameRateTimer, &QTimer::timeout, this, &Infrared::updateFrameRate);
+    connect(decodePool, &FrameDecodePool::frameDecoded, this, &Infrared::onFrameDecoded);
 
     // 初始化UDP
     initUdpSocket();
 
     // 启动帧率计时器（每秒更新一次）
     frameRateTimer->start(1000);
+    recordTimer->start(kRecordTickMs);
 
     // 添加一条初始记录
     addDetectionRecord(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"),
@@ -44,6 +159,11 @@ Infrared::Infrared(QWidget* parent) :
 }
 
 Infrared::~Infrared() {
+    // 检索任务会回调本对象，必须在析构前结束；已排队的结果随对象删除而丢弃
+    searchCancelled.store(true, std::memory_order_relaxed);
+    searchPool.waitForDone();
+    recordModel->flush();  // 未显示的记录也写入日志
+    receiver.reset();
     if (udpSocket) {
         udpSocket->close();
         delete udpSocket;
@@ -61,53 +181,32 @@ void Infrared::initUdpSocket() {
         return;
     }
 
+    // 视频流数据报较大且成批到达，加大内核接收缓冲区以容纳突发
+    receiver = std::make_unique<DatagramReceiver>(udpSocket, kReceiveBatch, kMaxDatagramSize, kSocketBufferBytes);
     connect(udpSocket, &QUdpSocket::readyRead, this, &Infrared::onUdpDataReceived);
 
     ui->statusLabel->setText(QString("UDP监听端口: %1 - 等待数据...").arg(udpPort));
 }
 
 void Infrared::onUdpDataReceived() {
-    while (udpSocket->hasPendingDatagrams()) {
-        QByteArray datagram;
-        datagram.resize(udpSocket->pendingDatagramSize());
-
-        QHostAddress sender;
-        quint16 senderPort;
-
-        udpSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
-
-        // 处理接收到的数据
-        processImageData(datagram);
-
-        frameCount++;
+    QByteArray frame;
+    while (const int count = receiver->receiveBatch()) {
+        // 分片数据报收齐一帧后再处理，不分片的数据报直接处理
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        reassembler.expire(now);
+        for (int i = 0; i < count; ++i) {
+            const DatagramReceiver::Datagram& datagram = receiver->datagram(i);
+            if (reassembler.push(datagram.data, datagram.size, now, frame)) {
+                processImageData(frame);
+            }
+        }
     }
 }
 
 void Infrared::processImageData(const QByteArray& data) {
-    // 尝试将数据解析为图像
-    QImage image;
-    if (image.loadFromData(data)) {
-        // 图像数据有效，显示在标签上
-        QPixmap pixmap = QPixmap::fromImage(image);
-
-        // 缩放图像以适应显示区域，保持宽高比
-        pixmap = pixmap.scaled(ui->videoLabel->width(),
-                              ui->videoLabel->height(),
-                              Qt::KeepAspectRatio,
-                              Qt::SmoothTransformation);
-
-        ui->videoLabel->setPixmap(pixmap);
-        ui->videoLabel->setAlignment(Qt::AlignCenter);
-
-        // 检测到运动（这里简单假设有数据就表示有运动）
-        static int motionCount = 0;
-        motionCount++;
-
-        if (motionCount % 10 == 0) {  // 每10帧记录一次检测结果
-            QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
-            QString status = "检测到运动";
-            addDetectionRecord(timestamp, status);
-        }
+    if (FrameDecodePool::looksLikeImage(data)) {
+        // 图像交给解码池在工作线程中解码；来不及解码的旧帧会被丢弃
+        decodePool->submit(data);
     } else {
         // 如果不是图像数据，尝试解析为文本信息
         QString textData = QString::fromUtf8(data);
@@ -121,40 +220,111 @@ void Infrared::processImageData(const QByteArray& data) {
     }
 }
 
-void Infrared::addDetectionRecord(const QString& timestamp, const QString& status) {
-    int row = ui->tableWidget->rowCount();
-    ui->tableWidget->insertRow(row);
+void Infrared::onFrameDecoded(const QImage& image, quint64 sequence) {
+    Q_UNUSED(sequence);
+    // 停止接收时画面停在最后一帧
+    if (!ui->videoSurface->isPaused()) {
+        // 图像已转换为可直接绘制的格式，缩放在绘制时进行
+        ui->videoSurface->setFrame(image);
+        frameCount++;
+    }
 
-    ui->tableWidget->setItem(row, 0, new QTableWidgetItem(timestamp));
-    ui->tableWidget->setItem(row, 1, new QTableWidgetItem(status));
-    ui->tableWidget->setItem(row, 2, new QTableWidgetItem("自动记录"));
+    // 检测到运动（这里简单假设有数据就表示有运动）
+    motionCount++;
 
-    // 自动滚动到最后一行
-    ui->tableWidget->scrollToBottom();
+    if (motionCount % 10 == 0) {  // 每10帧记录一次检测结果
+        QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss");
+        QString status = "检测到运动";
+        addDetectionRecord(timestamp, status);
+    }
+}
+
+void Infrared::addDetectionRecord(const QString& timestamp, const QString& status) {
+    // 先排队，由onRecordTick()批量插入
+    recordModel->append({timestamp, status, "自动记录"});
+}
+
+void Infrared::onRecordTick() {
+    if (recordModel->flush() > 0) {
+        // 每批只滚动一次到最后一行
+        ui->tableView->scrollToBottom();
+    }
 }
 
 void Infrared::onClearRecords() {
-    ui->tableWidget->setRowCount(0);
+    recordModel->clear();
     addDetectionRecord(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss"),
                       "记录已清空");
 }
 
+void Infrared::onSearchRecords() {
+    if (searching) {
+        return;  // 上一次检索尚未完成
+    }
+    recordModel->flush();  // 使日志包含所有已收到的记录
+    searching = true;
+    ui->btnSearch->setEnabled(false);
+    ui->btnSearch->setText("检索中...");
+
+    // 整个日志在工作线程中读取，结果排队回到界面线程显示
+    const QString text = ui->lineEditSearch->text().trimmed();
+    const QString path = detectionLog.path();
+    searchPool.start([this, text, path] {
+        const QVector<DetectionEvent> events = DetectionLog(path).search(text, kSearchLimit, &searchCancelled);
+        QMetaObject::invokeMethod(this, [this, events] {
+            showSearchResults(events);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void Infrared::showSearchResults(const QVector<DetectionEvent>& events) {
+    searching = false;
+    ui->btnSearch->setEnabled(true);
+    ui->btnSearch->setText("检索");
+
+    // 检索结果在单独的窗口中显示，不影响实时记录表格
+    auto* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(QString("检测记录检索: %1 条%2")
+                               .arg(events.size())
+                               .arg(events.size() >= kSearchLimit ? "（仅显示最近的记录）" : ""));
+    dialog->resize(600, 400);
+    auto* model = new DetectionEventModel(qMax(1, static_cast<int>(events.size())), nullptr, dialog);
+    model->setEvents(events);
+    auto* view = new QTableView(dialog);
+    view->setModel(model);
+    view->horizontalHeader()->setStretchLastSection(true);
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    auto* layout = new QVBoxLayout(dialog);
+    layout->addWidget(view);
+    dialog->show();
+}
+
 void Infrared::onStartStream() {
     if (udpSocket && udpSocket->state() == QUdpSocket::BoundState) {
         ui->statusLabel->setText(QString("UDP端口 %1 - 正在接收数据...").arg(udpPort));
+        ui->videoSurface->setPaused(false);
         ui->btnStartStream->setEnabled(false);
         ui->btnStopStream->setEnabled(true);
     }
 }
 
 void Infrared::onStopStream() {
-    ui->videoLabel->clear();
+    ui->videoSurface->setPaused(true);  // 保留最后一帧，暂停后改用平滑缩放
     ui->statusLabel->setText(QString("UDP端口 %1 - 已停止接收").arg(udpPort));
     ui->btnStartStream->setEnabled(true);
     ui->btnStopStream->setEnabled(false);
 }
 
 void Infrared::updateFrameRate() {
-    ui->frameRateLabel->setText(QString("帧率: %1 fps").arg(frameCount));
+    reassembler.expire(QDateTime::currentMSecsSinceEpoch());  // 数据中断时也清理未收齐的帧
+    const FrameReassembler::Stats& stats = reassembler.stats();
+    ui->frameRateLabel->setText(QString("帧率: %1 fps  丢帧: %2  不完整帧: %3  丢失分片: %4")
+                                    .arg(frameCount)
+                                    .arg(decodePool->droppedFrames())
+                                    .arg(stats.incompleteFrames)
+                                    .arg(stats.lostFragments));
     frameCount = 0;  // 重置计数器
 }
\ No newline at end of file
@@ -6,6 +6,14 @@
 #include <QImage>
 #include <QPixmap>
 #include <QTimer>
+#include <QAbstractTableModel>
+#include <QThreadPool>
+#include "FrameDecodePool.h"
+#include "FrameReassembler.h"
+#include "DatagramReceiver.h"
+#include "DetectionLog.h"
+#include <atomic>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -13,6 +21,44 @@ namespace Ui {
 }
 QT_END_NAMESPACE
 
+// 检测事件表格模型：环形缓冲区只保留最近capacity条，更早的事件只在磁盘日志中
+// 新事件先排队，每个界面周期调用flush()一次性插入，并把这一批写入日志
+class DetectionEventModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnTimestamp,
+        ColumnStatus,
+        ColumnRemark,
+        ColumnCount
+    };
+
+    // log为nullptr时不写日志（例如显示检索结果）
+    explicit DetectionEventModel(int capacity, DetectionLog* log = nullptr, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    void append(DetectionEvent event);  // 排队，flush()时才显示
+    int flush();                        // 插入排队的事件，返回插入的行数
+    void setEvents(const QVector<DetectionEvent>& events);  // 替换全部内容，不写日志
+    void clear();                       // 清空显示，日志保留
+
+private:
+    QVector<DetectionEvent> ring;     // 预先分配capacity个槽
+    int head = 0;                     // 最早一条所在的槽
+    int count = 0;
+    QVector<DetectionEvent> pending;  // 等待下一次flush()的事件
+    DetectionLog* log;
+
+    const DetectionEvent& at(int row) const {
+        return ring[(head + row) % ring.size()];
+    }
+};
+
 class Infrared : public QDialog {
     Q_OBJECT
 
@@ -26,17 +72,31 @@ private slots:
     void onStartStream();      // 开始视频流
     void onStopStream();       // 停止视频流
     void updateFrameRate();    // 更新帧率显示
+    void onFrameDecoded(const QImage& image, quint64 sequence);  // 显示解码完成的帧
+    void onRecordTick();       // 把排队的检测记录批量插入表格
+    void onSearchRecords();    // 在检测日志中检索
 
 private:
     Ui::Infrared* ui;
     QUdpSocket* udpSocket;     // UDP套接字
+    std::unique_ptr<DatagramReceiver> receiver;  // 批量读取数据报到预分配的缓冲区
     QTimer* frameRateTimer;    // 帧率计时器
-    int frameCount;            // 帧计数器
+    FrameReassembler reassembler;  // 分片数据报重组为完整帧
+    FrameDecodePool* decodePool;  // 图像在工作线程中解码，界面线程只负责显示
+    int frameCount;            // 帧计数器（已显示的帧）
+    int motionCount;           // 运动检测计数
     int udpPort;               // UDP端口号
+    DetectionLog detectionLog;       // 全部检测记录的磁盘日志
+    DetectionEventModel* recordModel;  // 表格只显示最近的记录
+    QTimer* recordTimer;       // 记录批量插入的周期
+    QThreadPool searchPool;    // 检索在工作线程中读日志，日志再大也不阻塞界面
+    std::atomic<bool> searchCancelled{false};  // 窗口关闭时中止正在进行的检索
+    bool searching = false;    // 同一时间只进行一次检索
 
     void initUdpSocket();      // 初始化UDP套接字
     void processImageData(const QByteArray& data);  // 处理图像数据
     void addDetectionRecord(const QString& timestamp, const QString& status);  // 添加检测记录
+    void showSearchResults(const QVector<DetectionEvent>& events);  // 检索完成后在界面线程显示结果
 };
 
 #endif //QTCLIENT_INFRARED_H
\ No newline at end of file
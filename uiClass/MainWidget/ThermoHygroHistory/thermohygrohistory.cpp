@@ -1,16 +1,52 @@
 #include "thermohygrohistory.h"
 #include "ui_ThermoHygroHistory.h"
+#include "DataPointRegistry.h"
 #include <QMessageBox>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QFileDialog>
+#include <QThread>
 #include <QDateTime>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+namespace {
+// 默认显示的数据点：温度、湿度
+constexpr int kDefaultKeys[] = {307, 304};
+// 距查询时刻不足此秒数的数据网关可能尚未入库，不标记为已缓存
+constexpr qint64 kSettleSeconds = 60;
+// 开关型泳道相对数值型泳道的高度
+constexpr double kStepLaneStretch = 0.4;
+// 实时跟踪模式的最高重绘帧率
+constexpr int kTailFps = 10;
+// 实时跟踪时每条曲线保留的最多点数，超出后丢弃最早的点（聚合桶不受影响）
+constexpr qsizetype kMaxTailPoints = qsizetype(1) << 21;
+// 超出上限此比例后才裁剪，避免每个新点都移动整个数组
+constexpr qsizetype kTailTrimSlack = kMaxTailPoints / 8;
+// 查询和缩放时的重绘间隔，期间到达的页和范围变化合并为一次
+constexpr int kRedrawIntervalMs = 16;
+
+const QColor kSeriesColors[] = {
+    QColor("#e74c3c"), QColor("#3498db"), QColor("#27ae60"), QColor("#f39c12"),
+    QColor("#8e44ad"), QColor("#16a085"), QColor("#d35400"), QColor("#2c3e50"),
+};
+
+bool isStepSeries(const DataPointRegistry::DataPoint* point) {
+    return point && point->type == DataPointRegistry::ValueType::Bool;
+}
+}
 
-ThermoHygroHistory::ThermoHygroHistory(QMqttClient* client, QWidget* parent) :
+ThermoHygroHistory::ThermoHygroHistory(MqttIngestWorker* worker, const TelemetryStore* telemetry, RollupEngine* rollups,
+                                       QWidget* parent) :
     QDialog(parent),
     ui(new Ui::ThermoHygroHistory),
-    mqttClient(client),
-    receivedCount(0), m_startTime(0),
+    mqttWorker(worker),
+    historyClient(nullptr),
+    telemetryStore(telemetry),
+    tailTimer(new QTimer(this)),
+    redrawTimer(new QTimer(this)),
+    rollupEngine(rollups),
+    m_startTime(0),
     m_endTime(0)
 {
     ui->setupUi(this);
@@ -21,61 +57,275 @@ ThermoHygroHistory::ThermoHygroHistory(QMqttClient* client, QWidget* parent) :
 
     // 连接查询按钮
     connect(ui->queryButton, &QPushButton::clicked, this, &ThermoHygroHistory::onQueryButtonClicked);
-
-    // 连接MQTT消息接收
-    if (mqttClient) {
-        connect(mqttClient, &QMqttClient::messageReceived, this, &ThermoHygroHistory::onMqttMessageReceived);
+    connect(ui->cancelButton, &QPushButton::clicked, this, &ThermoHygroHistory::onCancelButtonClicked);
+    ui->progressBar->setRange(0, 100);
+    ui->progressBar->setVisible(false);
+    ui->cancelButton->setEnabled(false);
+    ui->downsampleCombo->addItems({"最值降采样", "LTTB降采样", "原始数据"});
+    connect(ui->downsampleCombo, &QComboBox::currentIndexChanged, this, &ThermoHygroHistory::onDownsampleChanged);
+    ui->rollupCombo->addItems({"原始数据", "按小时聚合", "按天聚合"});
+    connect(ui->rollupCombo, &QComboBox::currentIndexChanged, this, &ThermoHygroHistory::onRollupChanged);
+    ui->rollupCombo->setEnabled(rollupEngine != nullptr);
+    ui->liveTailCheck->setEnabled(telemetryStore != nullptr);
+    connect(ui->liveTailCheck, &QCheckBox::toggled, this, &ThermoHygroHistory::onLiveTailToggled);
+    tailTimer->setInterval(1000 / kTailFps);
+    connect(tailTimer, &QTimer::timeout, this, &ThermoHygroHistory::onTailFrame);
+    redrawTimer->setSingleShot(true);
+    redrawTimer->setInterval(kRedrawIntervalMs);
+    connect(redrawTimer, &QTimer::timeout, this, &ThermoHygroHistory::onRedrawFrame);
+
+    // 历史查询回复按关联编号分发
+    if (mqttWorker) {
+        historyClient = new HistoryClient(mqttWorker, 10000, this);
+        connect(historyClient, &HistoryClient::pageReceived, this, &ThermoHygroHistory::onHistoryPage);
+        connect(historyClient, &HistoryClient::requestFailed, this, &ThermoHygroHistory::onHistoryFailed);
+        historyCache = std::make_unique<HistoryCache>(HistoryCache::defaultDirectory(mqttWorker->topic()));
     }
 
-    // 设置图表
-    setupChart();
+    connect(ui->exportButton, &QPushButton::clicked, this, &ThermoHygroHistory::onExportButtonClicked);
+
+    // 设置图表：只允许沿时间方向拖动和缩放，各泳道同步
+    ui->customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+    setupKeyList();
+    rebuildLanes(selectedKeys());
 }
 
 ThermoHygroHistory::~ThermoHygroHistory() {
+    stopExport();
     delete ui;
 }
 
-void ThermoHygroHistory::setupChart() {
-    // 设置图表标题
-    ui->customPlot->plotLayout()->insertRow(0);
-    ui->customPlot->plotLayout()->addElement(
-        0, 0, new QCPTextElement(ui->customPlot, "温湿度历史数据", QFont("sans", 12, QFont::Bold)));
+void ThermoHygroHistory::setupKeyList() {
+    // 列出点表中所有会上报的数据点
+    for (const DataPointRegistry::DataPoint& point : DataPointRegistry::kDataPoints) {
+        if (!DataPointRegistry::canReport(point.direction)) {
+            continue;
+        }
+        auto* item = new QListWidgetItem(QString("%1 (%2)").arg(point.label).arg(point.key), ui->keyList);
+        item->setData(Qt::UserRole, point.key);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        const bool checked = std::find(std::begin(kDefaultKeys), std::end(kDefaultKeys), point.key) != std::end(kDefaultKeys);
+        item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    }
+}
+
+QVector<int> ThermoHygroHistory::selectedKeys() const {
+    QVector<int> keys;
+    for (int i = 0; i < ui->keyList->count(); ++i) {
+        const QListWidgetItem* item = ui->keyList->item(i);
+        if (item->checkState() == Qt::Checked) {
+            keys.append(item->data(Qt::UserRole).toInt());
+        }
+    }
+    return keys;
+}
 
-    // 设置温度图表（左侧Y轴）
-    ui->customPlot->addGraph();
-    ui->customPlot->graph(0)->setPen(QPen(Qt::red));
-    ui->customPlot->graph(0)->setName("温度");
+void ThermoHygroHistory::rebuildLanes(const QVector<int>& keys) {
+    QCustomPlot* plot = ui->customPlot;
+    // 曲线引用泳道的坐标轴，必须先于泳道删除
+    plot->clearPlottables();
+    plot->plotLayout()->clear();
+    delete marginGroup;
+    marginGroup = new QCPMarginGroup(plot);
+    seriesList.clear();
 
-    // 设置湿度图表（右侧Y轴）
-    ui->customPlot->addGraph(ui->customPlot->xAxis, ui->customPlot->yAxis2);
-    ui->customPlot->graph(1)->setPen(QPen(Qt::blue));
-    ui->customPlot->graph(1)->setName("湿度");
+    plot->plotLayout()->addElement(0, 0, new QCPTextElement(plot, "历史数据", QFont("sans", 12, QFont::Bold)));
 
-    // 设置X轴为时间轴
     QSharedPointer<QCPAxisTickerDateTime> dateTicker(new QCPAxisTickerDateTime);
     dateTicker->setDateTimeFormat("MM-dd hh:mm");
-    ui->customPlot->xAxis->setTicker(dateTicker);
+    QSharedPointer<QCPAxisTickerText> switchTicker(new QCPAxisTickerText);
+    switchTicker->addTick(0, "关");
+    switchTicker->addTick(1, "开");
+
+    for (int i = 0; i < keys.size(); ++i) {
+        const DataPointRegistry::DataPoint* point = DataPointRegistry::find(keys[i]);
+        const bool step = isStepSeries(point);
+        const QColor color = kSeriesColors[i % std::size(kSeriesColors)];
+
+        auto* lane = new QCPAxisRect(plot);
+        plot->plotLayout()->addElement(i + 1, 0, lane);
+        plot->plotLayout()->setRowStretchFactor(i + 1, step ? kStepLaneStretch : 1.0);
+        lane->setRangeDrag(Qt::Horizontal);
+        lane->setRangeZoom(Qt::Horizontal);
+        lane->setMarginGroup(QCP::msLeft | QCP::msRight, marginGroup);
+
+        QCPAxis* xAxis = lane->axis(QCPAxis::atBottom);
+        xAxis->setTicker(dateTicker);
+        xAxis->setTickLabels(i == keys.size() - 1);  // 只在最下方泳道显示时间刻度
+        connect(xAxis, qOverload<const QCPRange&>(&QCPAxis::rangeChanged), this, &ThermoHygroHistory::onTimeRangeChanged);
+
+        QCPAxis* yAxis = lane->axis(QCPAxis::atLeft);
+        const QString label = point ? QString(point->label) : QString::number(keys[i]);
+        yAxis->setLabel(point && point->unit[0] ? QString("%1 (%2)").arg(label, point->unit) : label);
+        yAxis->setLabelColor(color);
+        yAxis->setTickLabelColor(color);
+
+        QCPGraph* graph = plot->addGraph(xAxis, yAxis);
+        graph->setPen(QPen(color));
+        graph->setName(label);
+        QCPFinancial* candles = nullptr;
+        if (step) {
+            graph->setLineStyle(QCPGraph::lsStepLeft);
+            yAxis->setTicker(switchTicker);
+            yAxis->setRange(-0.2, 1.2);
+        } else {
+            candles = new QCPFinancial(xAxis, yAxis);
+            candles->setChartStyle(QCPFinancial::csCandlestick);
+            candles->setTwoColored(true);
+            candles->setPenPositive(QPen(color));
+            candles->setPenNegative(QPen(color));
+            candles->setBrushPositive(QBrush(color.lighter(160)));
+            candles->setBrushNegative(QBrush(color));
+            candles->setVisible(rollupResolution >= 0);
+        }
 
-    // 设置Y轴
-    ui->customPlot->yAxis->setLabel("温度 (°C)");
-    ui->customPlot->yAxis->setLabelColor(Qt::red);
-    ui->customPlot->yAxis->setTickLabelColor(Qt::red);
+        Series series;
+        series.key = keys[i];
+        series.lane = lane;
+        series.graph = graph;
+        series.candles = candles;
+        seriesList.append(series);
+    }
+    plot->replot();
+}
+
+QCPAxis* ThermoHygroHistory::timeAxis() const {
+    return seriesList.isEmpty() ? nullptr : seriesList.last().lane->axis(QCPAxis::atBottom);
+}
 
-    // 设置右侧Y轴
-    ui->customPlot->yAxis2->setVisible(true);
-    ui->customPlot->yAxis2->setLabel("湿度 (%)");
-    ui->customPlot->yAxis2->setLabelColor(Qt::blue);
-    ui->customPlot->yAxis2->setTickLabelColor(Qt::blue);
+void ThermoHygroHistory::onTimeRangeChanged(const QCPRange& range) {
+    if (syncingTimeAxes) {
+        return;
+    }
+    syncingTimeAxes = true;
+    for (const Series& series : std::as_const(seriesList)) {
+        series.lane->axis(QCPAxis::atBottom)->setRange(range);
+    }
+    syncingTimeAxes = false;
+    if (!liveTail) {
+        markAllDirty();  // 实时跟踪时曲线数据由onTailFrame增量维护
+    }
+}
+
+void ThermoHygroHistory::markDirty(int series) {
+    seriesList[series].dirty = true;
+    if (!redrawTimer->isActive()) {
+        redrawTimer->start();
+    }
+}
+
+void ThermoHygroHistory::markAllDirty() {
+    for (Series& series : seriesList) {
+        series.dirty = true;
+    }
+    if (!redrawTimer->isActive()) {
+        redrawTimer->start();
+    }
+}
+
+void ThermoHygroHistory::onRedrawFrame() {
+    if (liveTail) {
+        return;  // 由onTailFrame重绘，退出实时跟踪时全部重新降采样
+    }
+    updateGraphs();
+    rescaleValueAxes();
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void ThermoHygroHistory::onLiveTailToggled(bool enabled) {
+    liveTail = enabled;
+    if (!enabled) {
+        tailTimer->stop();
+        markAllDirty();  // 曲线中只有窗口内的点
+        rescaleToData();
+        return;
+    }
+    tailReslice = true;
+    onTelemetryRecorded();  // 补上查询结束后已收到的实时点
+    tailDirty = true;
+    onTailFrame();
+    tailTimer->start();
+}
+
+void ThermoHygroHistory::onTelemetryRecorded() {
+    if (!liveTail) {
+        return;
+    }
+    for (Series& series : seriesList) {
+        const TelemetrySeries* live = telemetryStore->series(series.key);
+        if (!live || live->isEmpty()) {
+            continue;
+        }
+        // 只取比已有数据更新的点，环形缓冲区按时间顺序，从末尾往前找
+        const double newest = series.times.isEmpty() ? -1 : series.times.last();
+        int first = live->size();
+        while (first > 0 && live->timeAt(first - 1) > newest) {
+            --first;
+        }
+        for (int i = first; i < live->size(); ++i) {
+            const double time = live->timeAt(i);
+            const double value = live->valueAt(i);
+            series.times.append(time);
+            series.values.append(value);
+            if (rollupResolution < 0) {
+                series.graph->data()->add(QCPGraphData(time, value));  // 时间在末尾之后，追加不需排序
+            }
+            tailDirty = true;
+        }
+        if (series.times.size() > kMaxTailPoints + kTailTrimSlack) {
+            const qsizetype excess = series.times.size() - kMaxTailPoints;
+            series.times.remove(0, excess);
+            series.values.remove(0, excess);
+        }
+    }
+}
 
-    // 添加图例
-    ui->customPlot->legend->setVisible(true);
+void ThermoHygroHistory::onTailFrame() {
+    if (!tailDirty && !tailReslice) {
+        return;  // 没有新点时不重绘
+    }
+    const double upper = static_cast<double>(QDateTime::currentSecsSinceEpoch());
+    const double lower = upper - ui->tailWindowSpin->value() * 60.0;
+    if (rollupResolution >= 0) {
+        // 窗口内的桶很少，每帧直接重新生成
+        tailReslice = false;
+        if (timeAxis()) {
+            timeAxis()->setRange(lower, upper);
+        }
+        updateRollupGraphs();
+    } else {
+        if (tailReslice) {
+            sliceTailWindow(lower);
+            tailReslice = false;
+        }
+        for (const Series& series : std::as_const(seriesList)) {
+            series.graph->data()->removeBefore(lower);  // 只保留窗口内的点
+        }
+        if (timeAxis()) {
+            timeAxis()->setRange(lower, upper);
+        }
+    }
+    rescaleValueAxes();
+    tailDirty = false;
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
+}
 
-    // 设置交互
-    ui->customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectPlottables);
+void ThermoHygroHistory::sliceTailWindow(double lower) {
+    // 窗口内的点一般不多，不降采样
+    for (const Series& series : std::as_const(seriesList)) {
+        const auto begin = std::lower_bound(series.times.cbegin(), series.times.cend(), lower);
+        const qsizetype first = begin - series.times.cbegin();
+        QVector<QCPGraphData> points(series.times.size() - first);
+        for (qsizetype i = 0; i < points.size(); ++i) {
+            points[i].key = series.times[first + i];
+            points[i].value = series.values[first + i];
+        }
+        series.graph->data()->set(points, true);
+    }
 }
 
 void ThermoHygroHistory::onQueryButtonClicked() {
-    if (!mqttClient || mqttClient->state() != QMqttClient::Connected) {
+    if (!mqttWorker || mqttWorker->state() != QMqttClient::Connected) {
         QMessageBox::warning(this, "错误", "MQTT客户端未连接");
         return;
     }
@@ -89,99 +339,506 @@ void ThermoHygroHistory::onQueryButtonClicked() {
         return;
     }
 
-    // 清空现有数据
-    temperatureTime.clear();
-    temperatureValues.clear();
-    humidityTime.clear();
-    humidityValues.clear();
-    receivedCount = 0;
+    const QVector<int> keys = selectedKeys();
+    if (keys.isEmpty()) {
+        QMessageBox::warning(this, "错误", "请至少选择一个数据点");
+        return;
+    }
 
-    // 只先发送温度历史数据请求（第一个请求）
-    QJsonObject tempRequest;
-    tempRequest["type"] = 4;
+    // 放弃上一次未完成的查询，按所选数据点重建泳道
+    for (auto it = pendingQueries.cbegin(); it != pendingQueries.cend(); ++it) {
+        historyClient->cancel(it.key());
+    }
+    pendingQueries.clear();
+    queryErrors.clear();
+    queryFinished = 0;
+    rebuildLanes(keys);
+
+    // 先画出本地缓存中已有的部分；聚合模式直接按桶绘制，原始数据切回原始模式时再读
+    rawLoaded = rollupResolution < 0;
+    if (rawLoaded) {
+        for (Series& series : seriesList) {
+            historyCache->read(series.key, m_startTime, m_endTime, series.times, series.values);
+        }
+    }
 
-    QJsonObject tempData;
-    tempData["key"] = 307;
-    QJsonArray tempLimit;
-    tempLimit.append(static_cast<double>(m_startTime));
-    tempLimit.append(static_cast<double>(m_endTime));
-    tempData["limit"] = tempLimit;
+    // 只请求本地缓存中缺少的区间，所有数据点的请求同时发出，总耗时约为一次往返
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (int index = 0; index < seriesList.size(); ++index) {
+        const int key = seriesList[index].key;
+        const QVector<HistoryCache::Interval> gaps = historyCache->missing(key, m_startTime, m_endTime);
+        addCachedToRollups(key, gaps);
+        for (const HistoryCache::Interval& gap : gaps) {
+            PendingQuery query{index, gap.start, gap.end, now};
+            pendingQueries.insert(historyClient->request(key, gap.start, gap.end), query);
+        }
+    }
+    queryRequests = pendingQueries.size();
+    if (!pendingQueries.isEmpty()) {
+        ui->progressBar->setValue(0);
+        ui->progressBar->setVisible(true);
+        ui->cancelButton->setEnabled(true);
+    }
+    finishQueryIfDone();  // 全部命中缓存时立即完成
+}
 
-    tempRequest["data"] = tempData;
+void ThermoHygroHistory::onCancelButtonClicked() {
+    // 已收到的页保留在图表中，但不写入缓存
+    for (auto it = pendingQueries.cbegin(); it != pendingQueries.cend(); ++it) {
+        historyClient->cancel(it.key());
+    }
+    pendingQueries.clear();
+    finishQueryIfDone();
+}
+
+void ThermoHygroHistory::onHistoryPage(quint32 id, int key, const QVector<double>& times, const QVector<double>& values,
+                                       double progress, bool finished) {
+    const auto it = pendingQueries.find(id);
+    if (it == pendingQueries.end()) {
+        return;
+    }
+    PendingQuery& query = it.value();
+
+    // 每页到达即加入曲线，不等待整个区间
+    mergeIntoSeries(query.series, times, values);
+    query.times += times;
+    query.values += values;
+    query.progress = progress;
+
+    if (finished) {
+        // 缺口完整取回后才写入缓存，距查询时刻太近的尾部不标记为已缓存
+        const qint64 coveredEnd = qMin(query.end, query.sentTime - kSettleSeconds);
+        if (coveredEnd >= query.start) {
+            historyCache->store(key, query.start, coveredEnd, query.times, query.values);
+            if (rollupEngine) {
+                rollupEngine->addHistory(key, query.start, coveredEnd, query.times.constData(), query.values.constData(),
+                                         query.times.size());
+            }
+        }
+        pendingQueries.erase(it);
+        ++queryFinished;
+        updateQueryProgress();
+        finishQueryIfDone();
+        return;
+    }
 
-    QJsonDocument tempDoc(tempRequest);
-    mqttClient->publish(QString("up"), tempDoc.toJson());
+    updateQueryProgress();
+    rescaleToData();  // 同一帧内到达的多页只重绘一次
 }
 
-void ThermoHygroHistory::onMqttMessageReceived(const QByteArray& message, const QMqttTopicName& topic) {
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(message, &error);
+void ThermoHygroHistory::onHistoryFailed(quint32 id, int key, const QString& reason) {
+    const auto it = pendingQueries.constFind(id);
+    if (it == pendingQueries.cend()) {
+        return;
+    }
+    // 失败的缺口不写入缓存，已收到的页仍保留在曲线中
+    const PendingQuery& query = it.value();
+    queryErrors.append(QString("数据点%1 %2 ~ %3: %4")
+                           .arg(key)
+                           .arg(QDateTime::fromSecsSinceEpoch(query.start).toString("MM-dd hh:mm"),
+                                QDateTime::fromSecsSinceEpoch(query.end).toString("MM-dd hh:mm"), reason));
+    pendingQueries.erase(it);
+    ++queryFinished;
+    updateQueryProgress();
+    finishQueryIfDone();
+}
 
-    if (error.error != QJsonParseError::NoError) {
+void ThermoHygroHistory::updateQueryProgress() {
+    // 按发出的请求总数计算，已结束的请求从pendingQueries中移除后仍计为完成，进度不会回退
+    if (queryRequests == 0) {
         return;
     }
+    double total = queryFinished;
+    for (const PendingQuery& pending : std::as_const(pendingQueries)) {
+        total += pending.progress;
+    }
+    ui->progressBar->setValue(qRound(100 * total / queryRequests));
+}
 
-    QJsonObject rootObj = doc.object();
+void ThermoHygroHistory::finishQueryIfDone() {
+    // 所有请求都有结果后（成功、失败或取消）再统一调整范围并刷新
+    if (!pendingQueries.isEmpty()) {
+        return;
+    }
+    ui->progressBar->setVisible(false);
+    ui->cancelButton->setEnabled(false);
+    rescaleToData();
+    if (!queryErrors.isEmpty()) {
+        const QStringList errors = std::exchange(queryErrors, {});
+        QMessageBox::warning(this, "查询失败",
+                             QString("%1 个区间未能取回，图表中缺少这些数据：\n%2").arg(errors.size()).arg(errors.join('\n')));
+    }
+}
 
-    // 只处理历史数据回复（type=4）且成功返回（result=0）的消息
-    if (rootObj["type"].toInt() == 4 && rootObj["result"].toInt() == 0) {
-        int key = rootObj["key"].toInt();
-        QJsonArray dataArray = rootObj["data"].toArray();
+void ThermoHygroHistory::mergeIntoSeries(int index, const QVector<double>& times, const QVector<double>& values) {
+    if (times.isEmpty()) {
+        return;
+    }
+    Series& series = seriesList[index];
+    markDirty(index);
+    if (series.times.isEmpty() || times.first() > series.times.last()) {
+        series.times += times;
+        series.values += values;
+        return;
+    }
+    // 实时跟踪时缺口内可能已有实时点：与该时间段内的已有数据按时间归并，
+    // 同一时刻只保留一个点（以历史数据为准）
+    const qsizetype lo = std::lower_bound(series.times.cbegin(), series.times.cend(), times.first()) - series.times.cbegin();
+    const qsizetype hi = std::upper_bound(series.times.cbegin() + lo, series.times.cend(), times.last()) - series.times.cbegin();
+    QVector<double> mergedTimes;
+    QVector<double> mergedValues;
+    mergedTimes.reserve(hi - lo + times.size());
+    mergedValues.reserve(hi - lo + times.size());
+    qsizetype i = lo;
+    qsizetype j = 0;
+    while (i < hi || j < times.size()) {
+        if (j == times.size() || (i < hi && series.times[i] < times[j])) {
+            mergedTimes.append(series.times[i]);
+            mergedValues.append(series.values[i]);
+            ++i;
+            continue;
+        }
+        if (i < hi && series.times[i] == times[j]) {
+            ++i;  // 重复的点
+        }
+        mergedTimes.append(times[j]);
+        mergedValues.append(values[j]);
+        ++j;
+    }
+    series.times.remove(lo, hi - lo);
+    series.values.remove(lo, hi - lo);
+    series.times.insert(lo, mergedTimes.size(), 0.0);
+    series.values.insert(lo, mergedValues.size(), 0.0);
+    std::copy(mergedTimes.cbegin(), mergedTimes.cend(), series.times.begin() + lo);
+    std::copy(mergedValues.cbegin(), mergedValues.cend(), series.values.begin() + lo);
+}
 
-        processHistoryData(key, dataArray);
-        receivedCount++;
+void ThermoHygroHistory::loadCachedRaw() {
+    rawLoaded = true;
+    QVector<double> times;
+    QVector<double> values;
+    for (int index = 0; index < seriesList.size(); ++index) {
+        historyCache->read(seriesList[index].key, m_startTime, m_endTime, times, values);
+        mergeIntoSeries(index, times, values);  // 期间已收到的历史页与缓存重叠的点只保留一个
+    }
+}
 
-        // 收到温度回复后，再发送湿度请求（串行处理）
-        if (key == 307 && receivedCount == 1) {
-            // 发送湿度历史数据请求（第二个请求）
-            QJsonObject humiRequest;
-            humiRequest["type"] = 4;
+void ThermoHygroHistory::addCachedToRollups(int key, const QVector<HistoryCache::Interval>& gaps) {
+    if (!rollupEngine) {
+        return;
+    }
+    // 已缓存的区间即查询范围去掉缺口；其中尚未计入聚合的部分（如旧版本写入的缓存）补入一次，之后不再读取
+    QVector<double> times;
+    QVector<double> values;
+    qint64 cursor = m_startTime;
+    for (int i = 0; i <= gaps.size(); ++i) {
+        const qint64 cachedEnd = i < gaps.size() ? gaps[i].start - 1 : m_endTime;
+        if (cachedEnd >= cursor) {
+            for (const RollupEngine::Span& span : rollupEngine->uncounted(key, cursor, cachedEnd)) {
+                const qint64 start = static_cast<qint64>(std::floor(span.start));
+                const qint64 end = static_cast<qint64>(std::ceil(span.end));
+                historyCache->read(key, start, end, times, values);
+                rollupEngine->addHistory(key, start, end, times.constData(), values.constData(), times.size());
+            }
+        }
+        if (i < gaps.size()) {
+            cursor = gaps[i].end + 1;
+        }
+    }
+}
 
-            QJsonObject humiData;
-            humiData["key"] = 304;
-            QJsonArray humiLimit;
-            humiLimit.append(static_cast<double>(m_startTime));
-            humiLimit.append(static_cast<double>(m_endTime));
-            humiData["limit"] = humiLimit;
+void ThermoHygroHistory::rescaleToData() {
+    if (liveTail) {
+        // 实时跟踪时时间轴由窗口决定，下一帧重新取窗口内的数据
+        tailReslice = true;
+        return;
+    }
+    // 按全分辨率数据确定时间范围，降采样后的点不一定包含首尾；聚合模式显示查询的整个范围
+    double lower = m_startTime;
+    double upper = m_endTime;
+    bool found = false;
+    if (rollupResolution >= 0) {
+        found = m_endTime > m_startTime;
+    } else {
+        for (const Series& series : std::as_const(seriesList)) {
+            if (series.times.isEmpty()) {
+                continue;
+            }
+            lower = found ? qMin(lower, series.times.first()) : series.times.first();
+            upper = found ? qMax(upper, series.times.last()) : series.times.last();
+            found = true;
+        }
+    }
+    if (found && timeAxis()) {
+        timeAxis()->setRange(lower, upper);  // 范围有变化时onTimeRangeChanged标记全部曲线
+    }
+    // 范围未变时只有收到新数据的曲线需要重新降采样，在下一帧统一进行
+    if (!redrawTimer->isActive()) {
+        redrawTimer->start();
+    }
+}
 
-            humiRequest["data"] = humiData;
+void ThermoHygroHistory::rescaleValueAxes() {
+    // 开关型泳道的纵轴固定；聚合模式按K线的最高最低值调整
+    for (const Series& series : std::as_const(seriesList)) {
+        if (series.candles && series.candles->visible()) {
+            series.candles->rescaleValueAxis(false, true);
+        } else if (series.graph->lineStyle() != QCPGraph::lsStepLeft) {
+            series.graph->rescaleValueAxis(false, true);
+        }
+    }
+}
 
-            QJsonDocument humiDoc(humiRequest);
-            mqttClient->publish(QString("up"), humiDoc.toJson());
+void ThermoHygroHistory::updateGraphs() {
+    for (Series& series : seriesList) {
+        if (!series.dirty) {
+            continue;
+        }
+        series.dirty = false;
+        if (rollupResolution >= 0) {
+            updateRollupGraph(series);
+        } else {
+            updateSeriesGraph(series);
         }
+    }
+}
 
-        // 当收到两个响应后（温度+湿度），更新图表
-        if (receivedCount == 2) {
-            // 更新温度图表
-            ui->customPlot->graph(0)->setData(temperatureTime, temperatureValues);
+void ThermoHygroHistory::updateSeriesGraph(Series& series) {
+    QVector<qsizetype> selected;
+    const QCPRange range = series.lane->axis(QCPAxis::atBottom)->range();
+    const int pixels = qMax(1, series.lane->width());
+    // 可见范围两侧各多取一个点，使曲线延伸到绘图区边缘
+    const auto begin = std::lower_bound(series.times.cbegin(), series.times.cend(), range.lower);
+    const auto end = std::upper_bound(begin, series.times.cend(), range.upper);
+    const qsizetype first = qMax<qsizetype>(0, (begin - series.times.cbegin()) - 1);
+    const qsizetype last = qMin<qsizetype>(series.times.size(), (end - series.times.cbegin()) + 1);
+    const double* times = series.times.constData() + first;
+    const double* values = series.values.constData() + first;
+    const bool reduced = Downsampler::downsample(downsampleMethod, times, values, last - first, pixels, selected);
+
+    // 按最终点数一次分配，直接构造QCPGraphData；set()以隐式共享接管数组，
+    // 且数据已按时间排序，不再复制和排序
+    const qsizetype count = reduced ? selected.size() : last - first;
+    QVector<QCPGraphData> points(count);
+    QCPGraphData* out = points.data();
+    for (qsizetype i = 0; i < count; ++i) {
+        const qsizetype index = reduced ? selected[i] : i;
+        out[i].key = times[index];
+        out[i].value = values[index];
+    }
+    series.graph->data()->set(points, true);
+}
 
-            // 更新湿度图表
-            ui->customPlot->graph(1)->setData(humidityTime, humidityValues);
+void ThermoHygroHistory::updateRollupGraphs() {
+    for (const Series& series : std::as_const(seriesList)) {
+        updateRollupGraph(series);
+    }
+}
 
-            // 自动调整范围
-            ui->customPlot->rescaleAxes();
+void ThermoHygroHistory::updateRollupGraph(const Series& series) {
+    const auto resolution = static_cast<RollupEngine::Resolution>(rollupResolution);
+    const RollupSeries* rollup = rollupEngine ? rollupEngine->series(series.key, resolution) : nullptr;
+    QVector<QCPGraphData> means;
+    QVector<QCPFinancialData> bars;
+    if (rollup) {
+        // 可见范围两侧各多取一个桶
+        const QCPRange range = series.lane->axis(QCPAxis::atBottom)->range();
+        const double width = rollup->bucketSeconds();
+        const bool step = series.graph->lineStyle() == QCPGraph::lsStepLeft;
+        const QMap<qint64, RollupBucket>& buckets = rollup->buckets();
+        const auto end = buckets.upperBound(rollup->indexOf(range.upper) + 1);
+        for (auto it = buckets.lowerBound(rollup->indexOf(range.lower) - 1); it != end; ++it) {
+            const RollupBucket& bucket = it.value();
+            // 阶梯线从桶起点画起，K线画在桶中间
+            means.append(QCPGraphData(step ? bucket.start : bucket.start + width / 2, bucket.mean()));
+            bars.append(QCPFinancialData(bucket.start + width / 2, bucket.open, bucket.max, bucket.min, bucket.close));
+        }
+        if (series.candles) {
+            series.candles->setWidth(width * 0.8);
+        }
+    }
+    series.graph->data()->set(means, true);
+    if (series.candles) {
+        series.candles->data()->set(bars, true);
+    }
+}
 
-            // 刷新图表
-            ui->customPlot->replot();
+void ThermoHygroHistory::onRollupChanged(int index) {
+    // 0为原始数据，其余依次对应RollupEngine::Resolution
+    rollupResolution = index - 1;
+    const bool rolled = rollupResolution >= 0;
+    for (const Series& series : std::as_const(seriesList)) {
+        if (series.candles) {
+            series.candles->setVisible(rolled);
         }
     }
+    if (!rolled && !rawLoaded) {
+        loadCachedRaw();  // 本次查询在聚合模式下进行，尚未读出原始数据
+        rescaleToData();
+    }
+    if (liveTail) {
+        tailReslice = true;
+        tailDirty = true;
+        onTailFrame();
+    } else {
+        markAllDirty();
+    }
 }
 
-void ThermoHygroHistory::processHistoryData(int key, const QJsonArray& data) {
-    for (const auto& item : data) {
-        QJsonObject dataObj = item.toObject();
-        double time = dataObj["time"].toDouble();
-        double value = dataObj["val"].toString().toDouble();
+void ThermoHygroHistory::onDownsampleChanged(int index) {
+    static constexpr Downsampler::Method methods[] = {
+        Downsampler::Method::MinMax, Downsampler::Method::Lttb, Downsampler::Method::None
+    };
+    if (index < 0 || index >= static_cast<int>(std::size(methods))) {
+        return;
+    }
+    downsampleMethod = methods[index];
+    markAllDirty();
+}
 
-        if (key == 307) {
-            // 温度
-            temperatureTime.append(time);
-            temperatureValues.append(value);
-        }
-        else if (key == 304) {
-            // 湿度
-            humidityTime.append(time);
-            humidityValues.append(value);
+void ThermoHygroHistory::onExportButtonClicked() {
+    if (exporter) {
+        return;  // 同一时间只进行一个导出
+    }
+    if (!mqttWorker || mqttWorker->state() != QMqttClient::Connected) {
+        QMessageBox::warning(this, "错误", "MQTT客户端未连接");
+        return;
+    }
+    const QVector<int> keys = selectedKeys();
+    const qint64 startTime = ui->startDateTime->dateTime().toSecsSinceEpoch();
+    const qint64 endTime = ui->endDateTime->dateTime().toSecsSinceEpoch();
+    if (keys.isEmpty() || startTime >= endTime) {
+        QMessageBox::warning(this, "错误", "请选择数据点，且开始时间必须早于结束时间");
+        return;
+    }
+    const QString path = QFileDialog::getSaveFileName(this, "导出历史数据", "history.csv",
+                                                      "CSV文件 (*.csv);;列式二进制文件 (*.qthx)");
+    if (path.isEmpty()) {
+        return;
+    }
+
+    // 写文件在工作线程中进行，每页到达后排队交给导出器
+    exportThread = new QThread(this);
+    exporter = new HistoryExporter(path, HistoryExporter::formatForPath(path));
+    exporter->moveToThread(exportThread);
+    connect(exportThread, &QThread::finished, exporter, &QObject::deleteLater);
+    connect(exporter, &HistoryExporter::finished, this, &ThermoHygroHistory::onExportFinished);
+    exportThread->start();
+    QMetaObject::invokeMethod(exporter, &HistoryExporter::open, Qt::QueuedConnection);
+
+    if (!exportClient) {
+        exportClient = new HistoryClient(mqttWorker, 10000, this);
+        connect(exportClient, &HistoryClient::pageReceived, this, &ThermoHygroHistory::onExportPage);
+        connect(exportClient, &HistoryClient::requestFailed, this, &ThermoHygroHistory::onExportFailed);
+    }
+    exportError.clear();
+    exportCancelled = false;
+    exportFinished = 0;
+    for (const int key : keys) {
+        exportPending.insert(exportClient->request(key, startTime, endTime), 0.0);
+    }
+    exportRequests = exportPending.size();
+
+    exportProgress = new QProgressDialog("正在导出历史数据...", "取消", 0, 100, this);
+    exportProgress->setAttribute(Qt::WA_DeleteOnClose);
+    exportProgress->setMinimumDuration(0);
+    connect(exportProgress, &QProgressDialog::canceled, this, [this] {
+        // 关闭对话框时会再次发出canceled，先置空以免重入
+        QProgressDialog* dialog = std::exchange(exportProgress, nullptr);
+        if (!dialog) {
+            return;
         }
+        exportClient->cancelAll();
+        exportPending.clear();
+        exportCancelled = true;
+        dialog->close();  // 取消只会隐藏对话框，关闭后才按WA_DeleteOnClose释放
+        QMetaObject::invokeMethod(exporter, &HistoryExporter::abort, Qt::QueuedConnection);
+    });
+    exportProgress->show();
+}
+
+void ThermoHygroHistory::onExportPage(quint32 id, int key, const QVector<double>& times, const QVector<double>& values,
+                                      double progress, bool finished) {
+    const auto it = exportPending.find(id);
+    if (it == exportPending.end()) {
+        return;
+    }
+    // 页数据隐式共享，排队到工作线程时不复制
+    QMetaObject::invokeMethod(exporter, [exporter = exporter, key, times, values] {
+        exporter->writePage(key, times, values);
+    }, Qt::QueuedConnection);
+
+    if (finished) {
+        exportPending.erase(it);
+        ++exportFinished;
+        updateExportProgress();
+        finishExportIfDone();
+        return;
+    }
+    it.value() = progress;
+    updateExportProgress();
+}
+
+void ThermoHygroHistory::updateExportProgress() {
+    if (!exportProgress || exportRequests == 0) {
+        return;
+    }
+    double total = exportFinished;
+    for (const double value : std::as_const(exportPending)) {
+        total += value;
+    }
+    exportProgress->setValue(qRound(100 * total / exportRequests));
+}
+
+void ThermoHygroHistory::onExportFailed(quint32 id, int key, const QString& reason) {
+    if (exportPending.remove(id) == 0) {
+        return;
+    }
+    if (exportError.isEmpty()) {
+        exportError = QString("数据点%1: %2").arg(key).arg(reason);
+    }
+    ++exportFinished;
+    updateExportProgress();
+    finishExportIfDone();
+}
+
+void ThermoHygroHistory::finishExportIfDone() {
+    if (!exportPending.isEmpty()) {
+        return;
+    }
+    // 有请求失败时不生成不完整的文件
+    if (exportError.isEmpty()) {
+        QMetaObject::invokeMethod(exporter, &HistoryExporter::finish, Qt::QueuedConnection);
+    } else {
+        QMetaObject::invokeMethod(exporter, &HistoryExporter::abort, Qt::QueuedConnection);
+    }
+}
+
+void ThermoHygroHistory::onExportFinished(bool ok, const QString& errorMsg, qint64 points) {
+    if (QProgressDialog* dialog = std::exchange(exportProgress, nullptr)) {
+        dialog->close();
+    }
+    exportClient->cancelAll();
+    exportPending.clear();
+    stopExport();
+    if (exportCancelled) {
+        return;  // 用户取消，未写出文件，无需提示
+    }
+    if (ok) {
+        QMessageBox::information(this, "导出完成", QString("已导出 %1 个点").arg(points));
+    } else {
+        QMessageBox::warning(this, "导出失败", exportError.isEmpty() ? errorMsg : exportError);
+    }
+}
+
+void ThermoHygroHistory::stopExport() {
+    if (!exportThread) {
+        return;
     }
+    // 导出未完成时，未提交的QSaveFile随导出器释放而丢弃，不会留下不完整的文件
+    exportThread->quit();
+    exportThread->wait();
+    exportThread->deleteLater();
+    exportThread = nullptr;
+    exporter = nullptr;  // 随线程结束释放
 }
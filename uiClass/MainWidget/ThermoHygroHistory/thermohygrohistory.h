@@ -2,8 +2,15 @@
 #define QTCLIENT_THERMOHYGROHISTORY_H
 
 #include <QDialog>
-#include <QMqttClient>
-#include <QJsonArray>
+#include "MqttIngestWorker.h"
+#include "HistoryClient.h"
+#include "HistoryCache.h"
+#include "Downsampler.h"
+#include "RollupEngine.h"
+#include "TelemetrySeries.h"
+#include "HistoryExporter.h"
+#include <QProgressDialog>
+#include <memory>
 #include "qcustomplot.h"
 
 QT_BEGIN_NAMESPACE
@@ -12,30 +19,127 @@ namespace Ui {
 }
 QT_END_NAMESPACE
 
+// 历史数据浏览：可选择任意上报数据点，每个数据点一条纵向排列的泳道，共用时间轴
+// 数值型数据点为折线，开关型数据点为阶梯线
+// 聚合模式下按小时或按天显示：数值型为K线（首、最高、最低、末）加均值线，开关型为每桶的开启比例
+// 聚合直接从桶绘制，不读出本地缓存中的原始数据
 class ThermoHygroHistory : public QDialog {
     Q_OBJECT
 
 public:
-    explicit ThermoHygroHistory(QMqttClient* mqttClient, QWidget* parent = nullptr);
+    // telemetry为实时上报的时间序列，用于实时跟踪模式，可为nullptr
+    // rollups为主窗口持有的聚合，取回的历史数据会补入其中；为nullptr时不提供聚合模式
+    explicit ThermoHygroHistory(MqttIngestWorker* mqttWorker, const TelemetryStore* telemetry = nullptr,
+                                RollupEngine* rollups = nullptr, QWidget* parent = nullptr);
     ~ThermoHygroHistory() override;
 
+public slots:
+    // 实时数据已更新：实时跟踪模式下把新上报的点追加到曲线
+    void onTelemetryRecorded();
+
 private slots:
     void onQueryButtonClicked();
-    void onMqttMessageReceived(const QByteArray& message, const QMqttTopicName& topic);
+    void onCancelButtonClicked();
+    void onHistoryPage(quint32 id, int key, const QVector<double>& times, const QVector<double>& values,
+                       double progress, bool finished);
+    void onHistoryFailed(quint32 id, int key, const QString& reason);
+    void onDownsampleChanged(int index);
+    void onRollupChanged(int index);
+    void onTimeRangeChanged(const QCPRange& range);  // 同步各泳道的时间轴
+    void onRedrawFrame();  // 合并后的重绘：只重新降采样有变化的曲线
+    void onLiveTailToggled(bool enabled);
+    void onTailFrame();   // 实时跟踪的帧：滑动窗口并重绘
+    void onExportButtonClicked();
+    void onExportPage(quint32 id, int key, const QVector<double>& times, const QVector<double>& values,
+                      double progress, bool finished);
+    void onExportFailed(quint32 id, int key, const QString& reason);
+    void onExportFinished(bool ok, const QString& errorMsg, qint64 points);
 
 private:
     Ui::ThermoHygroHistory* ui;
-    QMqttClient* mqttClient;
-    QVector<double> temperatureTime;
-    QVector<double> temperatureValues;
-    QVector<double> humidityTime;
-    QVector<double> humidityValues;
+    MqttIngestWorker* mqttWorker;  // MQTT连接（运行在网络线程上）
+    HistoryClient* historyClient;  // 历史查询，请求按关联编号匹配回复
+    std::unique_ptr<HistoryCache> historyCache;  // 本地缓存，只向网关请求缺口
+
+    // 一个向网关请求的缺口区间
+    struct PendingQuery {
+        int series;       // 曲线序号
+        qint64 start;
+        qint64 end;
+        qint64 sentTime;  // 发出请求时的Unix秒
+        double progress = 0;     // 已取回的比例
+        QVector<double> times;   // 已收到的页，完整后写入缓存
+        QVector<double> values;
+    };
+    QHash<quint32, PendingQuery> pendingQueries;  // 未完成的请求编号 -> 缺口
+    QStringList queryErrors;  // 本次查询中失败的请求，全部结束后统一提示
+    int queryRequests = 0;    // 本次查询发出的请求数，进度按此计算，已结束的请求计为完成
+    int queryFinished = 0;
+
+    // 每个数据点一条曲线，保存全分辨率数据（按时间升序），图表中只放降采样后的点，放大时从这里重新取
+    struct Series {
+        int key = 0;
+        QCPAxisRect* lane = nullptr;  // 所在泳道
+        QCPGraph* graph = nullptr;          // 原始模式为数据点，聚合模式为每桶均值
+        QCPFinancial* candles = nullptr;    // 聚合模式的K线，开关型数据点没有
+        QVector<double> times;
+        QVector<double> values;
+        bool dirty = true;  // 数据或可见范围有变化，下一帧重新降采样
+    };
+    QVector<Series> seriesList;
+    QTimer* redrawTimer;  // 单次定时器，把同一帧内的多次变化合并为一次重绘
+    QCPMarginGroup* marginGroup = nullptr;  // 对齐各泳道的左右边距
+    bool syncingTimeAxes = false;
+
+    // 实时跟踪：新点直接追加到曲线数据，窗口外的点从曲线中移除，重绘限制在固定帧率
+    const TelemetryStore* telemetryStore;
+    QTimer* tailTimer;
+    bool liveTail = false;
+    bool tailDirty = false;    // 有新点，下一帧需要重绘
+    bool tailReslice = false;  // 历史数据有变化，下一帧从全分辨率数据重新取窗口
+    Downsampler::Method downsampleMethod = Downsampler::Method::MinMax;
+
+    // 聚合：实时点由主窗口计入，完整取回的缺口和尚未计入的缓存数据由本窗口补入
+    RollupEngine* rollupEngine;
+    int rollupResolution = -1;  // RollupEngine::Resolution，-1为显示原始数据
+    bool rawLoaded = true;      // 本次查询的缓存原始数据是否已读入曲线（聚合模式下查询时不读）
+
+    // 导出：单独的查询直接转发到工作线程写文件，界面线程不保留数据
+    HistoryClient* exportClient = nullptr;
+    QThread* exportThread = nullptr;
+    HistoryExporter* exporter = nullptr;
+    QProgressDialog* exportProgress = nullptr;
+    QHash<quint32, double> exportPending;  // 未完成的导出请求 -> 进度
+    int exportRequests = 0;                // 本次导出发出的请求数
+    int exportFinished = 0;                // 已结束（完成或失败）的请求数
+    bool exportCancelled = false;          // 用户取消，结束时不提示
+    QString exportError;                   // 第一个失败的请求
+
+    void updateExportProgress();
+    void finishExportIfDone();
+    void stopExport();
+
     qint64 m_startTime;  // 保存查询开始时间
     qint64 m_endTime;    // 保存查询结束时间
-    int receivedCount; // 计数器，用于跟踪收到的响应数量
 
-    void setupChart();
-    void processHistoryData(int key, const QJsonArray& data);
+    void setupKeyList();
+    QVector<int> selectedKeys() const;
+    void rebuildLanes(const QVector<int>& keys);
+    QCPAxis* timeAxis() const;
+    void updateQueryProgress();
+    void finishQueryIfDone();
+    void mergeIntoSeries(int series, const QVector<double>& times, const QVector<double>& values);
+    void loadCachedRaw();
+    void addCachedToRollups(int key, const QVector<HistoryCache::Interval>& gaps);
+    void rescaleToData();
+    void rescaleValueAxes();
+    void markDirty(int series);
+    void markAllDirty();
+    void updateGraphs();  // 按当前可见范围和绘图区宽度重新降采样有变化的曲线
+    void updateSeriesGraph(Series& series);
+    void updateRollupGraph(const Series& series);
+    void updateRollupGraphs();
+    void sliceTailWindow(double lower);
 };
 
-#endif // QTCLIENT_THERMOHYGROHISTORY_H
\ No newline at end of file
+#endif // QTCLIENT_THERMOHYGROHISTORY_H
@@ -6,20 +6,29 @@
 #include <utility>
 #include <QJsonArray>  // 添加QJsonArray头文件
 
+#include "DataPointRegistry.h"
+#include "CommandBatcher.h"
+#include "SetpointLimiter.h"
 #include "Infrared/infrared.h"
 #include "ThermoHygroHistory/thermohygrohistory.h"
+#include "Diagnostics/diagnostics.h"
+#include <QScopeGuard>
+#include <QFileDialog>
+
+namespace {
+// 开关按钮样式只构造一次，避免每次刷新重复生成样式字符串
+void applySwitchButton(QPushButton* button, bool on) {
+    static const QString onStyle = "QPushButton { background-color: #4CAF50; color: white; }";   // 开：绿色背景
+    static const QString offStyle = "QPushButton { background-color: #e74c3c; color: #3c4043; }"; // 关：默认样式
+    button->setText(on ? "开" : "关");
+    button->setStyleSheet(on ? onStyle : offStyle);
+}
+}
 
 // 构造函数：初始化成员变量、UI和MQTT客户端
 MainWidget::MainWidget(QWidget* parent,QString ip,QString topic) :
     QMainWindow(parent),
     ui(new Ui::MainWidget),
-    // 初始化设备状态（默认均为关闭）
-    ledState(false), buzzerState(false), fanState(false),
-    doorLockState(false), tvState(false), infraredState(false),
-    airConditionerState(false),
-    // 初始化传感器数据（默认值）
-    temperature(0.0), humidity(0.0),
-    waterHeaterTemp(0.0), airConditionerTemp(25),  // 空调默认25℃
     // 初始化阈值（默认值）
     tempUpperThreshold(30.0), tempLowerThreshold(10.0),  // 温度阈值10-30℃
     humiUpperThreshold(70.0), humiLowerThreshold(30.0),  // 湿度阈值30-70%
@@ -29,6 +38,26 @@ MainWidget::MainWidget(QWidget* parent,QString ip,QString topic) :
     ui->setupUi(this);  // 初始化UI界面（加载.ui文件定义的控件）
     setWindowTitle("智能家居控制中心");  // 设置窗口标题
 
+    // 界面刷新定时器：单次触发，把一帧内的多次状态变化合并为一次刷新
+    refreshTimer = new QTimer(this);
+    refreshTimer->setSingleShot(true);
+    connect(refreshTimer, &QTimer::timeout, this, &MainWidget::updateDeviceUI);
+
+    // 控制指令合并器：合并窗口结束后发布到控制指令主题
+    commandBatcher = new CommandBatcher(20, this);
+    connect(commandBatcher, &CommandBatcher::batchReady, this, [this](const QByteArray& payload, const QVector<int>& keys) {
+        if (mqttWorker->state() == QMqttClient::Connected) {
+            // QoS 1：broker确认后才认为其中的设定值已送达
+            inFlightBatches.insert(mqttWorker->publish(QString("up"), payload, 1), keys);
+        }
+    });
+
+    // 设定值限速器：滑块拖动期间按key限速，尾值必发，放行的值进入合并器
+    setpointLimiter = new SetpointLimiter(200, 2000, this);
+    connect(setpointLimiter, &SetpointLimiter::released, this, [this](int key, const QString& val) {
+        commandBatcher->enqueue(key, val);
+    });
+
     // 连接信号与槽：将按钮点击事件绑定到对应的控制函数
     connect(ui->btnLed, &QPushButton::clicked, this, &MainWidget::onLedClicked);
     connect(ui->btnBuzzer, &QPushButton::clicked, this, &MainWidget::onBuzzerClicked);
@@ -44,6 +73,9 @@ MainWidget::MainWidget(QWidget* parent,QString ip,QString topic) :
     connect(ui->WaterHeatersetbar,&QSlider::valueChanged,this,&MainWidget::onWaterHeaterChanged);
     connect(ui->btnRefresh, &QPushButton::clicked, this, &MainWidget::onRefreshClicked);
     connect(ui->btnMode, &QPushButton::clicked, this, &MainWidget::onModeClicked);
+    connect(ui->btnAllOff, &QPushButton::clicked, this, &MainWidget::onAllOffClicked);
+    connect(ui->btnDiagnostics, &QPushButton::clicked, this, &MainWidget::onDiagnosticsClicked);
+    connect(ui->btnCapture, &QPushButton::toggled, this, &MainWidget::onCaptureToggled);
 
     updateDeviceUI();  // 初始化UI显示（根据默认状态刷新控件）
     initMqttClient();  // 初始化MQTT客户端
@@ -51,217 +83,194 @@ MainWidget::MainWidget(QWidget* parent,QString ip,QString topic) :
 
 // 析构函数：释放资源
 MainWidget::~MainWidget() {
-    if (mqttClient) {
-        mqttClient->disconnectFromHost();  // 断开MQTT连接
-        delete mqttClient;                 // 释放MQTT客户端
+    if (networkThread) {
+        // 在网络线程中断开MQTT连接，再结束线程（工作对象随线程结束自动释放）
+        QMetaObject::invokeMethod(mqttWorker, &MqttIngestWorker::stop, Qt::BlockingQueuedConnection);
+        networkThread->quit();
+        networkThread->wait();
+    }
+    if (!rollupPath.isEmpty()) {
+        rollupEngine.save(rollupPath);  // 下次启动时长时间范围的聚合无需重新取回
     }
     delete ui;  // 释放UI指针
 }
 
-// 初始化MQTT客户端：设置连接参数并连接到服务器
+// 初始化MQTT客户端：连接由独立网络线程持有，界面线程只接收解码后的样本
 void MainWidget::initMqttClient() {
-    mqttClient = new QMqttClient(this);
+    networkThread = new QThread(this);
     // 使用传入的ip作为MQTT服务器地址（替代原"localhost"）
-    mqttClient->setHostname(this->ip);
-    mqttClient->setPort(1883);          // 保持默认端口
+    mqttWorker = new MqttIngestWorker(ip, topic, &ingestMetrics);
+    mqttWorker->moveToThread(networkThread);
+    if (!ip.isEmpty()) {
+        rollupPath = RollupEngine::defaultPath(mqttWorker->topic());
+        rollupEngine.load(rollupPath);
+    }
 
-    connect(mqttClient, &QMqttClient::stateChanged, this, &MainWidget::onMqttStateChanged);
-    connect(mqttClient, &QMqttClient::messageReceived, this, &MainWidget::onMqttMessageReceived);
+    connect(networkThread, &QThread::started, mqttWorker, &MqttIngestWorker::start);
+    connect(networkThread, &QThread::finished, mqttWorker, &QObject::deleteLater);
+    connect(mqttWorker, &MqttIngestWorker::samplesAvailable, this, &MainWidget::onTelemetryAvailable);
+    connect(mqttWorker, &MqttIngestWorker::published, this, &MainWidget::onCommandPublished);
+    connect(mqttWorker, &MqttIngestWorker::captureFailed, this, [this](const QString& errorMsg) {
+        ui->btnCapture->setChecked(false);
+        QMessageBox::warning(this, "录制失败", errorMsg);
+    });
+    connect(mqttWorker, &MqttIngestWorker::stateChanged, this, [this](QMqttClient::ClientState state) {
+        if (state == QMqttClient::Disconnected) {
+            inFlightBatches.clear();  // 断线后不会再有确认，由限速器超时放行
+            rollupEngine.breakLive(); // 断线期间的数据只能从历史查询补入聚合
+        }
+    });
 
-    mqttClient->connectToHost();
+    networkThread->start();
 }
 
-// 处理收到的MQTT消息：解析JSON并更新传感器数据
-void MainWidget::onMqttMessageReceived(const QByteArray& message, const QMqttTopicName& topic) {
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(message, &error);
+// 控制指令已被broker确认：放开其中各key的在途限制
+void MainWidget::onCommandPublished(quint64 token) {
+    const QVector<int> keys = inFlightBatches.take(token);
+    for (const int key : keys) {
+        setpointLimiter->acknowledge(key);
+    }
+}
 
-    if (error.error != QJsonParseError::NoError) {
-        // 解析失败则返回
+// 网络线程有新的采集样本：一次取完，每个样本写入时间序列，界面合并最新快照中上报过的字段
+void MainWidget::onTelemetryAvailable() {
+    TelemetrySample latest;
+    const qint64 nowNs = IngestMetrics::nowNs();
+    const int count = mqttWorker->drain(latest, [this, nowNs](const TelemetrySample& sample) {
+        telemetryStore.record(sample.time, sample.state, sample.reported);
+        rollupEngine.record(sample.time, sample.state, sample.reported);
+        ingestMetrics.ingestLatency().record(nowNs - sample.arrivalNs);
+    });
+    if (count == 0) {
         return;
     }
+    emit telemetryRecorded();
+    // 本地操作会先改写界面状态，所以每个上报字段都要覆盖，变化与否按界面状态判断，
+    // 不能用网络线程自己那份状态的变化位
+    const quint32 differs = deviceState.differences(latest.state, latest.reported);
+    deviceState.merge(latest.state, latest.reported);
+    markDirty(differs); // 只安排刷新与界面显示不同的控件
+}
 
-    QJsonObject rootObj = doc.object();
-
-    // 只处理采集回复指令（type=1）且成功返回（result=0）的消息
-    if (rootObj["type"].toInt() == 1 && rootObj["result"].toInt() == 0) {
-        // 提取数据点数组
-        QJsonArray dataArray = rootObj["data"].toArray();
-        if (dataArray.isEmpty()) {
-            return;
-        }
-
-        // 遍历所有数据点，根据key更新对应设备/传感器状态
-        for (const auto& val : dataArray) {
-            QJsonObject dataObj = val.toObject();
-            int key = dataObj["key"].toInt(); // 数据点key
-            QString valStr = dataObj["val"].toString(); // 数据点值（字符串）
-
-            // 根据点表映射key与设备/传感器
-            switch (key) {
-            // stm32模块 - 灯（key=301，type=1："1"=开，"0"=关）
-            case 301:
-                ledState = (valStr == "true");
-                break;
-            // stm32模块 - 蜂鸣器（key=302，type=1）
-            case 302:
-                buzzerState = (valStr == "true");
-                break;
-            // stm32模块 - 风扇（key=303，type=1）
-            case 303:
-                fanState = (valStr == "true");
-                break;
-            // stm32模块 - 湿度（key=304）
-            case 304:
-                humidity = valStr.toDouble();
-                break;
-
-            //305和306是湿度上下限阈值，无需采集
-
-            // stm32模块 - 温度（key=1）
-            case 307:
-                temperature = valStr.toDouble();
-                break;
-
-            //308和309是温度上下限阈值无需采集
-
-            // stm32模块 - 人体红外（key=310，type=1）
-            case 310:
-                infraredState = (valStr == "true");
-                break;
-            // stm32模块 - 门锁（key=311，type=1）
-            case 311:
-                doorLockState = (valStr == "true");
-                break;
-            // modbus模块 - 电视（key=101，type=1）
-            case 101:
-                tvState = (valStr == "true");
-                break;
-            // modbus模块 - 热水器温度（key=103，type=3）
-            case 103:
-                waterHeaterTemp = valStr.toDouble();
-                break;
-            // modbus模块 - 空调开关（key=104，type=1）
-            case 104:
-                airConditionerState = (valStr == "true");
-                break;
-            // modbus模块 - 空调温度（key=105，type=3）
-            case 105:
-                airConditionerTemp = valStr.toDouble();
-                break;
-            // 其他未用到的key可在此扩展
-            default:
-                break;
-            }
-        }
+// 标记需要刷新的字段：同一帧内的多次变化合并为一次界面刷新
+void MainWidget::markDirty(quint32 fields) {
+    dirtyFields |= fields;
+    if (dirtyFields == 0 || refreshTimer->isActive()) {
+        return;  // 无变化，或本帧已安排刷新
+    }
+    // 距上次刷新不足一帧时延后到帧边界，否则尽快刷新
+    qint64 wait = 0;
+    if (lastRefresh.isValid()) {
+        wait = qMax<qint64>(0, refreshIntervalMs - lastRefresh.elapsed());
     }
-    updateDeviceUI(); // 刷新UI显示
+    refreshTimer->start(static_cast<int>(wait));
 }
 
-// 处理MQTT连接状态变化：连接成功时订阅主题
-void MainWidget::onMqttStateChanged(const QMqttClient::ClientState state) const {
-    if (state == QMqttClient::Connected) {  // 当客户端连接成功时
-        // 可扩展：订阅需要的主题（如控制指令反馈、传感器数据等）
-        mqttClient->subscribe(topic);
-    }
+// 设置界面刷新频率上限（Hz）
+void MainWidget::setRefreshRate(int hz) {
+    refreshIntervalMs = 1000 / qMax(1, hz);
 }
 
-// 更新UI界面：根据设备状态和传感器数据刷新控件显示
+// 更新UI界面：只刷新自上次刷新以来发生变化的控件
 void MainWidget::updateDeviceUI() {
-    // 更新LED灯按钮显示（文字和样式）
-    ui->btnLed->setText(ledState ? "开" : "关");
-    ui->btnLed->setStyleSheet(ledState ?
-        "QPushButton { background-color: #4CAF50; color: white; }" :  // 开：绿色背景
-        "QPushButton { background-color: #e74c3c; color: #3c4043; }"); // 关：默认样式
-
-    // 更新蜂鸣器按钮显示
-    ui->btnBuzzer->setText(buzzerState ? "开" : "关");
-    ui->btnBuzzer->setStyleSheet(buzzerState ?
-        "QPushButton { background-color: #4CAF50; color: white; }" :
-        "QPushButton { background-color: #e74c3c; color: #3c4043; }");
-
-    // 更新风扇按钮显示
-    ui->btnFan->setText(fanState ? "开" : "关");
-    ui->btnFan->setStyleSheet(fanState ?
-        "QPushButton { background-color: #4CAF50; color: white; }" :
-        "QPushButton { background-color: #e74c3c; color: #3c4043; }");
-
-    // 更新门锁按钮显示
-    ui->btnDoorLock->setText(doorLockState ? "开" : "关");
-    ui->btnDoorLock->setStyleSheet(doorLockState ?
-        "QPushButton { background-color: #4CAF50; color: white; }" :
-        "QPushButton { background-color: #e74c3c; color: #3c4043; }");
-
-    // 更新电视按钮显示
-    ui->btnTv->setText(tvState ? "开" : "关");
-    ui->btnTv->setStyleSheet(tvState ?
-        "QPushButton { background-color: #4CAF50; color: white; }" :
-        "QPushButton { background-color: #e74c3c; color: #3c4043; }");
-
-    // 更新空调按钮显示
-    ui->btnAirConditioner->setText(airConditionerState ? "开" : "关");
-    ui->btnAirConditioner->setStyleSheet(airConditionerState ?
-        "QPushButton { background-color: #4CAF50; color: white; }" :
-        "QPushButton { background-color: #e74c3c; color: #3c4043; }");
+    const quint32 dirty = dirtyFields;
+    dirtyFields = 0;
+    lastRefresh.restart();
+
+    // 记录本次刷新耗时（离开作用域时写入直方图）
+    QElapsedTimer updateTimer;
+    updateTimer.start();
+    const auto recordTime = qScopeGuard([this, &updateTimer] {
+        ingestMetrics.uiUpdateTime().record(updateTimer.nsecsElapsed());
+    });
+
+    // 更新各开关设备按钮显示（文字和样式）
+    if (dirty & FieldLed) {
+        applySwitchButton(ui->btnLed, deviceState.ledState);
+    }
+    if (dirty & FieldBuzzer) {
+        applySwitchButton(ui->btnBuzzer, deviceState.buzzerState);
+    }
+    if (dirty & FieldFan) {
+        applySwitchButton(ui->btnFan, deviceState.fanState);
+    }
+    if (dirty & FieldDoorLock) {
+        applySwitchButton(ui->btnDoorLock, deviceState.doorLockState);
+    }
+    if (dirty & FieldTv) {
+        applySwitchButton(ui->btnTv, deviceState.tvState);
+    }
+    if (dirty & FieldAirConditioner) {
+        applySwitchButton(ui->btnAirConditioner, deviceState.airConditionerState);
+    }
 
     // 更新温度显示标签
-    ui->lblTemperature->setText(QString("温度: %1 °C").arg(temperature, 0, 'f', 2));
+    if (dirty & FieldTemperature) {
+        ui->lblTemperature->setText(QString("温度: %1 °C").arg(deviceState.temperature, 0, 'f', 2));
+    }
     // 更新湿度显示标签
-    ui->lblHumidity->setText(QString("湿度: %1 %").arg(humidity, 0, 'f', 2));
+    if (dirty & FieldHumidity) {
+        ui->lblHumidity->setText(QString("湿度: %1 %").arg(deviceState.humidity, 0, 'f', 2));
+    }
     // 更新热水器温度显示标签
-    ui->lblWaterHeater->setText(QString("水温: %1 °C").arg(waterHeaterTemp, 0, 'f', 2));
+    if (dirty & FieldWaterHeaterTemp) {
+        ui->lblWaterHeater->setText(QString("水温: %1 °C").arg(deviceState.waterHeaterTemp, 0, 'f', 2));
+    }
     // 更新红外传感器显示标签（文字和颜色）
-    ui->lblInfrared->setText(infraredState ? "检测到人体" : "未检测到");
-    ui->lblInfrared->setStyleSheet(infraredState ? "color: #F44336;" : "color: #3c4043;");  // 检测到：红色
+    if (dirty & FieldInfrared) {
+        static const QString detectedStyle = "color: #F44336;";  // 检测到：红色
+        static const QString idleStyle = "color: #3c4043;";
+        ui->lblInfrared->setText(deviceState.infraredState ? "检测到人体" : "未检测到");
+        ui->lblInfrared->setStyleSheet(deviceState.infraredState ? detectedStyle : idleStyle);
+    }
 
     // 更新空调温度显示标签
-    ui->lblAirConditionerTemp->setText(QString("温度: %1°C").arg(airConditionerTemp));
+    if (dirty & FieldAirConditionerTemp) {
+        ui->lblAirConditionerTemp->setText(QString("温度: %1°C").arg(deviceState.airConditionerTemp));
+    }
     //热水器温度标签
-    ui->waterHeartlab->setText(QString("预设温度：%1°C").arg(waterHeaterLowerThreshold));
+    if (dirty & FieldWaterHeaterSetpoint) {
+        ui->waterHeartlab->setText(QString("预设温度：%1°C").arg(waterHeaterLowerThreshold));
+    }
 }
 
 // 发布设备状态到MQTT服务器：将设备开关状态以JSON格式发送
-void MainWidget::publishDeviceState(const QString& device, bool state) {
+void MainWidget::publishDeviceState(DeviceField field, bool state) {
+    publishControl(field, state ? QStringLiteral("true") : QStringLiteral("false"));  // 开关状态（字符串类型）
+}
+
+// 发布控制指令：按点表把字段映射为数据点key，只发送可控制的数据点
+void MainWidget::publishControl(DeviceField field, const QString& val) {
     // 检查MQTT客户端是否存在且已连接
-    if (!mqttClient || mqttClient->state() != QMqttClient::Connected) {
+    if (mqttWorker->state() != QMqttClient::Connected) {
         return;  // 未连接则不发送
     }
 
-    // 仅保留需要控制的五个外设映射（根据点表）
-    QMap<QString, int> deviceKeyMap = {
-        {"led", 301},                  // LED灯（stm32的light）
-        {"buzzer", 302},               // 蜂鸣器（stm32的fengmingqi）
-        {"fan", 303},                  // 风扇（stm32的fan）
-        {"door_lock", 311},            // 门锁（stm32的lock）
-        {"air_conditioner", 104},       // 空调（modbus的air-switch）
-        {"tv",101}                      //电视
-    };
-
-    // 检查设备是否在需要控制的列表中
-    if (!deviceKeyMap.contains(device)) {
-        return;  // 非目标设备不发送
+    const DataPointRegistry::DataPoint* point = DataPointRegistry::findByField(field);
+    if (!point || !DataPointRegistry::canControl(point->direction)) {
+        return;  // 非控制目标不发送
     }
 
-    // 构造JSON消息体（符合指定格式）
-    QJsonObject rootJson;
-    rootJson["type"] = 2;  // 指令类型：2-控制指令
-
-    QJsonObject dataJson;
-    dataJson["key"] = deviceKeyMap[device];  // 数据点唯一标识
-    dataJson["val"] = state ? "true" : "false";  // 开关状态（字符串类型）
-
-    rootJson["data"] = dataJson;
-
-    QJsonDocument doc(rootJson);
-    // 发布消息到指定主题
-    mqttClient->publish(QString("up"), doc.toJson());
+    // 交给合并器：窗口内的多条控制写入合并为一条消息发送
+    commandBatcher->enqueue(point->key, val);
 }
 
+// 发布滑块设定值：经限速器按key限速，拖动过程中只发出部分中间值和最终值
+void MainWidget::publishSetpoint(DeviceField field, const QString& val) {
+    if (mqttWorker->state() != QMqttClient::Connected) {
+        return;
+    }
+    const DataPointRegistry::DataPoint* point = DataPointRegistry::findByField(field);
+    if (!point || !DataPointRegistry::canControl(point->direction)) {
+        return;
+    }
+    setpointLimiter->submit(point->key, val);
+}
 
 // 发布传感器阈值到MQTT服务器：将传感器上下限阈值以JSON格式发送
 void MainWidget::publishSensorThreshold(const QString& sensor, float lower, float upper) {
     // 检查MQTT客户端是否存在且已连接
-    if (!mqttClient || mqttClient->state() != QMqttClient::Connected) {
+    if (mqttWorker->state() != QMqttClient::Connected) {
         return;  // 未连接则不发送
     }
 
@@ -274,50 +283,54 @@ void MainWidget::publishSensorThreshold(const QString& sensor, float lower, floa
 
     QJsonDocument doc(json);  // 序列化JSON对象为字节数组
     // 发布消息到指定主题（threshold/传感器名）
-    mqttClient->publish(QString("threshold/%1").arg(sensor), doc.toJson());
+    mqttWorker->publish(QString("threshold/%1").arg(sensor), doc.toJson());
 }
 
 // LED灯控制：切换状态并发布到MQTT
 void MainWidget::onLedClicked() {
-    ledState = !ledState;  // 切换LED状态（取反）
-    updateDeviceUI();      // 刷新UI
-    publishDeviceState("led", ledState);  // 发布状态到MQTT
+    deviceState.ledState = !deviceState.ledState;  // 切换LED状态（取反）
+    markDirty(FieldLed);
+    publishDeviceState(FieldLed, deviceState.ledState);  // 发布状态到MQTT
 }
 
 // 蜂鸣器控制：切换状态并发布到MQTT
 void MainWidget::onBuzzerClicked() {
-    buzzerState = !buzzerState;
-    updateDeviceUI();
-    publishDeviceState("buzzer", buzzerState);
+    deviceState.buzzerState = !deviceState.buzzerState;
+    markDirty(FieldBuzzer);
+    publishDeviceState(FieldBuzzer, deviceState.buzzerState);
 }
 
 // 风扇控制：切换状态并发布到MQTT
 void MainWidget::onFanClicked() {
-    fanState = !fanState;
-    updateDeviceUI();
-    publishDeviceState("fan", fanState);
+    deviceState.fanState = !deviceState.fanState;
+    markDirty(FieldFan);
+    publishDeviceState(FieldFan, deviceState.fanState);
 }
 
 // 门锁控制：切换状态并发布到MQTT
 void MainWidget::onDoorLockClicked() {
-    doorLockState = !doorLockState;
-    updateDeviceUI();
-    publishDeviceState("door_lock", doorLockState);
+    deviceState.doorLockState = !deviceState.doorLockState;
+    markDirty(FieldDoorLock);
+    publishDeviceState(FieldDoorLock, deviceState.doorLockState);
 }
 
 // 电视控制：切换状态并发布到MQTT
 void MainWidget::onTvClicked() {
-    tvState = !tvState;
-    updateDeviceUI();
-    publishDeviceState("tv", tvState);
+    deviceState.tvState = !deviceState.tvState;
+    markDirty(FieldTv);
+    publishDeviceState(FieldTv, deviceState.tvState);
 }
 
 // 温湿度计控制：弹出阈值设置提示（待实现）
 void MainWidget::onThermoHygroClicked() {
     // 创建并显示温湿度历史记录窗口
-    auto* historyDialog = new ThermoHygroHistory(mqttClient, this);
+    auto* historyDialog = new ThermoHygroHistory(mqttWorker, &telemetryStore, &rollupEngine, this);
+    connect(this, &MainWidget::telemetryRecorded, historyDialog, &ThermoHygroHistory::onTelemetryRecorded);
     historyDialog->setAttribute(Qt::WA_DeleteOnClose); // 关闭时自动删除
     historyDialog->exec(); // 模态显示
+    if (!rollupPath.isEmpty()) {
+        rollupEngine.save(rollupPath);  // 保存本次补入的历史聚合
+    }
 }
 
 // 红外传感器控制：弹出详情提示（待实现）
@@ -331,63 +344,88 @@ void MainWidget::onInfraredClicked() {
 
 // 空调开关控制：切换状态并发布到MQTT
 void MainWidget::onAirConditionerClicked() {
-    airConditionerState = !airConditionerState;
-    updateDeviceUI();
-    publishDeviceState("air_conditioner", airConditionerState);
+    deviceState.airConditionerState = !deviceState.airConditionerState;
+    markDirty(FieldAirConditioner);
+    publishDeviceState(FieldAirConditioner, deviceState.airConditionerState);
 }
 
 // 空调温度调节：更新温度并发布到MQTT
 void MainWidget::onAirConditionerTempChanged(int value) {
-    airConditionerTemp = value;  // 更新空调设定温度
-    updateDeviceUI();            // 刷新UI显示
-
-    // 检查MQTT客户端是否连接
-    if (!mqttClient || mqttClient->state() != QMqttClient::Connected) {
-        return;
-    }
-
-    // 构造符合要求的控制指令JSON格式
-    QJsonObject rootJson;
-    rootJson["type"] = 2;  // 指令类型：2-控制指令
-
-    QJsonObject dataJson;
-    dataJson["key"] = 105; // 空调温度对应的数据点key
-    dataJson["val"] = QString::number(value); // 温度值转为字符串类型
-
-    rootJson["data"] = dataJson;
+    deviceState.airConditionerTemp = value;  // 更新空调设定温度
+    markDirty(FieldAirConditionerTemp);      // 安排刷新UI显示
 
-    QJsonDocument doc(rootJson);
-    // 发布到控制指令主题（与其他设备控制保持一致）
-    mqttClient->publish(QString("up"), doc.toJson());
+    publishSetpoint(FieldAirConditionerTemp, QString::number(value)); // 温度值转为字符串类型
 }
 //热水器
 void MainWidget::onWaterHeaterChanged(int value) {
     waterHeaterLowerThreshold = value;
-    updateDeviceUI();
-    if (!mqttClient || mqttClient->state() != QMqttClient::Connected) {
+    markDirty(FieldWaterHeaterSetpoint);
+    publishSetpoint(FieldWaterHeaterSetpoint, QString::number(value));
+}
+// 一键全关：所有开关设备的控制写入在同一合并窗口内，只产生一条消息
+void MainWidget::onAllOffClicked() {
+    deviceState.ledState = false;
+    deviceState.buzzerState = false;
+    deviceState.fanState = false;
+    deviceState.doorLockState = false;
+    deviceState.tvState = false;
+    deviceState.airConditionerState = false;
+    markDirty(FieldLed | FieldBuzzer | FieldFan | FieldDoorLock | FieldTv | FieldAirConditioner);
+
+    for (const DeviceField field : {FieldLed, FieldBuzzer, FieldFan, FieldDoorLock, FieldTv, FieldAirConditioner}) {
+        publishDeviceState(field, false);
+    }
+}
+
+// 运行诊断：显示接收/发布指标
+void MainWidget::onDiagnosticsClicked() {
+    if (diagnosticsDialog) {
+        // 已经打开时切到前台，不再创建第二个窗口（各自的定时器和重置按钮会互相干扰）
+        diagnosticsDialog->raise();
+        diagnosticsDialog->activateWindow();
         return;
     }
-    QJsonObject rootJson;
-    rootJson["type"] = 2;
-    QJsonObject dataJson;
-    dataJson["key"] = 102;
-    dataJson["val"] = QString::number(value);
-    rootJson["data"] = dataJson;
-    QJsonDocument doc(rootJson);
-    mqttClient->publish(QString("up"), doc.toJson());
+    diagnosticsDialog = new Diagnostics(&ingestMetrics, this);
+    diagnosticsDialog->setAttribute(Qt::WA_DeleteOnClose); // 关闭时自动删除，QPointer随之置空
+    diagnosticsDialog->show(); // 非模态显示，便于边操作边观察
 }
+
+// 录制报文：把收到的原始MQTT报文写入录制文件，供离线回放（--replay）
+void MainWidget::onCaptureToggled(bool checked) {
+    if (!checked) {
+        mqttWorker->stopCapture();
+        ui->btnCapture->setText("录制报文");
+        return;
+    }
+    const QString defaultName = QString("capture-%1.qtcap")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+    const QString path = QFileDialog::getSaveFileName(this, "录制报文", defaultName, "MQTT录制文件 (*.qtcap)");
+    if (path.isEmpty()) {
+        const QSignalBlocker blocker(ui->btnCapture);
+        ui->btnCapture->setChecked(false);
+        return;
+    }
+    mqttWorker->startCapture(path);
+    ui->btnCapture->setText("停止录制");
+}
+
+// 设置控制指令合并窗口（毫秒）
+void MainWidget::setCommandWindow(int windowMs) {
+    commandBatcher->setWindow(windowMs);
+}
+
 void MainWidget::onRefreshClicked() {
-    if (!mqttClient||mqttClient->state() != QMqttClient::Connected) {
+    if (mqttWorker->state() != QMqttClient::Connected) {
         return;
     }
     QJsonObject rootJson;
     rootJson["type"] = 1;
     rootJson["limit"] = "all";
     QJsonDocument doc(rootJson);
-    mqttClient->publish(QString("up"), doc.toJson());
+    mqttWorker->publish(QString("up"), doc.toJson());
 }
 void MainWidget::onModeClicked() {
-    if (!mqttClient||mqttClient->state() != QMqttClient::Connected) {
+    if (mqttWorker->state() != QMqttClient::Connected) {
         return;
     }
     mod++;
@@ -412,5 +450,5 @@ void MainWidget::onModeClicked() {
     dataJson["period"] = 5;
     rootJson["data"] = dataJson;
     QJsonDocument doc(rootJson);
-    mqttClient->publish(QString("up"), doc.toJson());
+    mqttWorker->publish(QString("up"), doc.toJson());
 }
\ No newline at end of file
@@ -2,8 +2,20 @@
 #define QTCLIENT_MAINWIDGET_H
 
 #include <QMainWindow>       // 包含QMainWindow类，用于创建主窗口
-#include <QMqttClient>       // 包含QMqttClient类，用于MQTT协议通信
+#include <QThread>           // 网络线程
 #include <QJsonObject>       // 包含QJsonObject类，用于JSON数据处理
+#include <QTimer>            // 界面刷新定时器
+#include <QElapsedTimer>     // 记录上次刷新时间，用于限制刷新频率
+#include <QPointer>          // 非模态对话框关闭后自动置空
+#include "DeviceState.h"     // 设备状态结构体
+#include "MqttIngestWorker.h" // 网络线程上的MQTT接收与解码
+#include "TelemetrySeries.h"  // 实时数据的环形时间序列
+#include "RollupEngine.h"     // 各数据点的小时/日聚合
+#include "IngestMetrics.h"    // 接收/发布路径的运行指标
+
+class CommandBatcher;
+class SetpointLimiter;
+class Diagnostics;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWidget; }  // 声明UI命名空间中的MainWidget类（由.ui文件生成）
@@ -14,16 +26,34 @@ class MainWidget : public QMainWindow {
     Q_OBJECT  // Qt元对象系统宏，支持信号与槽机制
 
 public:
-    // 构造函数：parent为父窗口指针，默认为nullptr
+    // 构造函数：parent为父窗口指针，默认为nullptr；ip为空时不连接broker（离线回放模式）
     explicit MainWidget(QWidget* parent = nullptr,QString ip="",QString topic="");
     // 析构函数：重写父类析构函数
     ~MainWidget() override;
 
+    // 设置界面刷新频率上限（Hz），默认30Hz
+    void setRefreshRate(int hz);
+    // 设置控制指令合并窗口（毫秒），默认20ms
+    void setCommandWindow(int windowMs);
+
+    // 各数据点最近的实时数据（定长环形缓冲区，趋势/迷你图可直接读取）
+    const TelemetryStore& telemetry() const { return telemetryStore; }
+    // 各数据点的小时/日聚合（实时样本与取回的历史数据）
+    RollupEngine& rollups() { return rollupEngine; }
+
+    // 接收路径与运行指标（供录制回放等离线工具使用）
+    MqttIngestWorker* ingestWorker() const { return mqttWorker; }
+    IngestMetrics& metrics() { return ingestMetrics; }
+
+signals:
+    // 新的上报已写入telemetry()，同一批样本只发出一次
+    void telemetryRecorded();
+
 private slots:
-    // MQTT消息接收槽函数：处理收到的MQTT消息和对应的主题
-    void onMqttMessageReceived(const QByteArray &message, const QMqttTopicName &topic);
-    // MQTT连接状态变化槽函数：处理MQTT客户端连接状态变化
-    void onMqttStateChanged(QMqttClient::ClientState state) const;
+    // 采集样本到达槽函数：从网络线程的环形缓冲区取出最新样本
+    void onTelemetryAvailable();
+    // 控制指令发布确认槽函数：token为MqttIngestWorker::publish返回的令牌
+    void onCommandPublished(quint64 token);
 
     // 设备控制槽函数：对应各个设备的点击事件
     void onLedClicked();         // LED灯控制
@@ -36,6 +66,9 @@ private slots:
     void onAirConditionerClicked(); // 空调开关控制
     void onRefreshClicked();     // 刷新按钮点击
     void onModeClicked();        // 模式切换按钮点击
+    void onAllOffClicked();      // 一键全关按钮点击
+    void onDiagnosticsClicked(); // 运行诊断按钮点击
+    void onCaptureToggled(bool checked); // 录制报文按钮切换
 
     // 空调温度调节槽函数：处理空调温度滑块变化
     void onAirConditionerTempChanged(int value);
@@ -44,24 +77,17 @@ private slots:
 
 private:
     Ui::MainWidget* ui;          // UI界面指针，用于访问界面控件
-    QMqttClient* mqttClient=nullptr;     // MQTT客户端指针，用于MQTT通信
+    QThread* networkThread=nullptr;      // 网络线程，持有MQTT连接
+    MqttIngestWorker* mqttWorker=nullptr; // MQTT接收工作对象（运行在networkThread上）
     QString ip;             // MQTT代理服务器IP地址
     QString topic;          // MQTT主题前缀
 
-    // 设备状态变量：记录各设备的开关状态
-    bool ledState;               // LED灯状态（true为开，false为关）
-    bool buzzerState;            // 蜂鸣器状态
-    bool fanState;               // 风扇状态
-    bool doorLockState;          // 门锁状态
-    bool tvState;                // 电视状态
-    bool infraredState;          // 红外传感器状态（检测到/未检测到人体）
-    bool airConditionerState;    // 空调开关状态
-
-    // 传感器数据：记录各传感器的实时数据
-    float temperature;           // 温度值（℃）
-    float humidity;              // 湿度值（%）
-    float waterHeaterTemp;       // 热水器温度（℃）
-    int airConditionerTemp;      // 空调设定温度（℃）
+    IngestMetrics ingestMetrics;      // 运行指标（网络线程与界面线程共同写入，析构时网络线程已结束）
+    // 设备状态与传感器数据：上报字段由onTelemetryAvailable合并，本地操作直接修改
+    DeviceState deviceState;
+    TelemetryStore telemetryStore;    // 每个数据点最近的上报值（时间列+数值列）
+    RollupEngine rollupEngine;        // 每个数据点的小时/日聚合，历史窗口也向其中补入取回的数据
+    QString rollupPath;               // 聚合的保存位置，离线回放模式为空（不读写文件）
 
     // 阈值变量：记录各传感器的上下限阈值（用于自动控制逻辑）
     float tempUpperThreshold;    // 温度上限阈值
@@ -71,11 +97,27 @@ private:
     int waterHeaterLowerThreshold; // 热水器温度下限阈值
     int mod=2;                  //记录模式
 
+    // 界面刷新调度：变化的字段先置脏，再由定时器按帧率上限统一刷新
+    QTimer* refreshTimer=nullptr;     // 单次触发的刷新定时器
+    QElapsedTimer lastRefresh;        // 上次刷新以来经过的时间
+    quint32 dirtyFields=FieldAll;     // 待刷新的字段位（DeviceField），初始全部刷新
+    int refreshIntervalMs=1000/30;    // 最小刷新间隔（毫秒）
+
+    CommandBatcher* commandBatcher=nullptr; // 控制指令合并器
+    SetpointLimiter* setpointLimiter=nullptr; // 滑块设定值限速器
+    QHash<quint64, QVector<int>> inFlightBatches; // 等待broker确认的批次令牌 -> 其中的key
+    QPointer<Diagnostics> diagnosticsDialog;      // 已打开的诊断窗口（同一时间只有一个）
+
     // 私有成员函数
-    void initMqttClient();       // 初始化MQTT客户端（设置连接参数、连接信号槽）
-    void updateDeviceUI();       // 更新UI界面（根据设备状态和传感器数据刷新控件显示）
-    // 发布设备状态到MQTT服务器：device为设备名称，state为开关状态
-    void publishDeviceState(const QString& device, bool state);
+    void initMqttClient();       // 初始化MQTT客户端（在网络线程中连接，连接信号槽）
+    void updateDeviceUI();       // 更新UI界面（只刷新dirtyFields标记的控件）
+    void markDirty(quint32 fields); // 标记变化的字段并按帧率上限安排刷新
+    // 发布设备状态到MQTT服务器：field为设备对应的状态字段，state为开关状态
+    void publishDeviceState(DeviceField field, bool state);
+    // 发布控制指令（type=2）：field经点表映射为数据点key，val为字符串值
+    void publishControl(DeviceField field, const QString& val);
+    // 发布滑块设定值（type=2）：经SetpointLimiter限速后再进入合并器
+    void publishSetpoint(DeviceField field, const QString& val);
     // 发布传感器阈值到MQTT服务器：sensor为传感器名称，lower为下限，upper为上限
     void publishSensorThreshold(const QString& sensor, float lower, float upper);
 };
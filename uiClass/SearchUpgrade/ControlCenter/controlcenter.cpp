@@ -0,0 +1,149 @@
+#include "controlcenter.h"
+#include "ui_controlcenter.h"
+#include <QColor>
+#include <QDateTime>
+#include <climits>
+#include <QHeaderView>
+
+namespace {
+// 汇总表格的刷新间隔：所有网关共用一个定时器，与网关数量无关
+constexpr int kRefreshIntervalMs = 200;
+
+QString connectionText(QMqttClient::ClientState state) {
+    switch (state) {
+        case QMqttClient::Connected: return "已连接";
+        case QMqttClient::Connecting: return "连接中";
+        default: return "未连接";
+    }
+}
+
+QString reportedText(const GatewaySnapshot& gateway, DeviceField field, const QString& text) {
+    return (gateway.reported & field) ? text : QString("--");
+}
+}
+
+GatewayTableModel::GatewayTableModel(QObject* parent) : QAbstractTableModel(parent) {
+}
+
+int GatewayTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+int GatewayTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant GatewayTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return {};
+    }
+    const GatewaySnapshot& gateway = rows[index.row()];
+    const DeviceState& device = gateway.device;
+
+    if (role == Qt::ForegroundRole && index.column() == ColumnConnection) {
+        return QColor(gateway.connection == QMqttClient::Connected ? "#2ecc71" : "#e74c3c");
+    }
+    if (role != Qt::DisplayRole) {
+        return {};
+    }
+
+    switch (index.column()) {
+        case ColumnIp: return gateway.ip;
+        case ColumnTopic: return gateway.topic;
+        case ColumnConnection: return connectionText(gateway.connection);
+        case ColumnTemperature:
+            return reportedText(gateway, FieldTemperature, QString::number(device.temperature, 'f', 1) + "°C");
+        case ColumnHumidity:
+            return reportedText(gateway, FieldHumidity, QString::number(device.humidity, 'f', 1) + "%");
+        case ColumnWaterHeater:
+            return reportedText(gateway, FieldWaterHeaterTemp, QString::number(device.waterHeaterTemp, 'f', 1) + "°C");
+        case ColumnAirConditioner:
+            return reportedText(gateway, FieldAirConditioner,
+                                device.airConditionerState ? QString("开 %1°C").arg(device.airConditionerTemp) : QString("关"));
+        case ColumnDoorLock:
+            return reportedText(gateway, FieldDoorLock, device.doorLockState ? "开" : "关");
+        case ColumnMessages: return gateway.messages;
+        case ColumnLastReport:
+            return gateway.lastReportMs == 0
+                       ? QString("--")
+                       : QDateTime::fromMSecsSinceEpoch(gateway.lastReportMs).toString("HH:mm:ss");
+        default: return {};
+    }
+}
+
+QVariant GatewayTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    static const char* const headers[ColumnCount] = {
+        "IP", "主题", "连接", "温度", "湿度", "热水器", "空调", "门锁", "报文数", "最近上报"
+    };
+    return section >= 0 && section < ColumnCount ? QString(headers[section]) : QVariant();
+}
+
+void GatewayTableModel::update(const QVector<int>& ids, const QVector<GatewaySnapshot>& snapshots) {
+    int firstChanged = INT_MAX;
+    int lastChanged = -1;
+    for (int i = 0; i < ids.size(); ++i) {
+        const int id = ids[i];
+        if (id >= rows.size()) {
+            beginInsertRows(QModelIndex(), static_cast<int>(rows.size()), id);
+            rows.resize(id + 1);
+            rows[id] = snapshots[i];
+            endInsertRows();
+            continue;
+        }
+        rows[id] = snapshots[i];
+        firstChanged = qMin(firstChanged, id);
+        lastChanged = qMax(lastChanged, id);
+    }
+    // 合并为一次dataChanged，避免每行触发一次视图重绘
+    if (lastChanged >= 0) {
+        emit dataChanged(index(firstChanged, 0), index(lastChanged, ColumnCount - 1));
+    }
+}
+
+ControlCenter::ControlCenter(QWidget* parent) :
+    QWidget(parent),
+    ui(new Ui::ControlCenter),
+    gatewayManager(new GatewayManager(0, this)),
+    model(new GatewayTableModel(this)),
+    refreshTimer(new QTimer(this)) {
+    ui->setupUi(this);
+
+    ui->tableGateways->setModel(model);
+    ui->tableGateways->horizontalHeader()->setStretchLastSection(true);
+    ui->tableGateways->verticalHeader()->setVisible(false);
+    ui->tableGateways->setSelectionBehavior(QAbstractItemView::SelectRows);
+
+    connect(ui->btnAdd, &QPushButton::clicked, this, &ControlCenter::onAddClicked);
+    connect(refreshTimer, &QTimer::timeout, this, &ControlCenter::refresh);
+    refreshTimer->start(kRefreshIntervalMs);
+}
+
+ControlCenter::~ControlCenter() {
+    delete ui;
+}
+
+void ControlCenter::addGateway(const QString& ip, const QString& topic) {
+    gatewayManager->addGateway(ip, topic);
+    ui->labelStatus->setText(QString("共 %1 个网关").arg(gatewayManager->gatewayCount()));
+}
+
+void ControlCenter::onAddClicked() {
+    const QString ip = ui->lineEditIp->text().trimmed();
+    const QString topic = ui->lineEditTopic->text().trimmed();
+    if (ip.isEmpty() || topic.isEmpty()) {
+        return;
+    }
+    addGateway(ip, topic);
+    ui->lineEditIp->clear();
+    ui->lineEditTopic->clear();
+}
+
+void ControlCenter::refresh() {
+    const QVector<int> ids = gatewayManager->takeDirty(changedSnapshots);
+    if (!ids.isEmpty()) {
+        model->update(ids, changedSnapshots);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef QTCLIENT_CONTROLCENTER_H
+#define QTCLIENT_CONTROLCENTER_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QAbstractTableModel>
+#include "GatewayManager.h"
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+    class ControlCenter;
+}
+QT_END_NAMESPACE
+
+// 网关汇总表格模型：每行一个网关，数据来自GatewayManager的快照
+class GatewayTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        ColumnIp,
+        ColumnTopic,
+        ColumnConnection,
+        ColumnTemperature,
+        ColumnHumidity,
+        ColumnWaterHeater,
+        ColumnAirConditioner,
+        ColumnDoorLock,
+        ColumnMessages,
+        ColumnLastReport,
+        ColumnCount
+    };
+
+    explicit GatewayTableModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    // 按网关编号更新行（编号连续分配，新编号追加为新行）
+    void update(const QVector<int>& ids, const QVector<GatewaySnapshot>& snapshots);
+
+private:
+    QVector<GatewaySnapshot> rows;
+};
+
+// 集中控制窗口：同时连接多个网关并在一张表中汇总显示
+class ControlCenter : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit ControlCenter(QWidget* parent = nullptr);
+    ~ControlCenter() override;
+
+    void addGateway(const QString& ip, const QString& topic);
+
+private slots:
+    void onAddClicked();
+    void refresh();  // 定时拉取发生变化的网关
+
+private:
+    Ui::ControlCenter* ui;
+    GatewayManager* gatewayManager;
+    GatewayTableModel* model;
+    QTimer* refreshTimer;
+    QVector<GatewaySnapshot> changedSnapshots;  // 复用的拉取缓冲区
+};
+
+#endif //QTCLIENT_CONTROLCENTER_H
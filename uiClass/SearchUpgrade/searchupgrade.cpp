@@ -6,6 +6,7 @@
 #include <QJsonDocument>  // 包含JSON文档类，用于JSON数据的序列化/反序列化
 #include <QJsonObject>  // 包含JSON对象类，用于处理JSON键值对
 #include "LinkPush/linkpush.h"
+#include "ControlCenter/controlcenter.h"
 
 /**
  * @brief SearchUpgrade类的构造函数
@@ -40,6 +41,14 @@ SearchUpgrade::SearchUpgrade(QWidget* parent) :
         QMessageBox::warning(this, "错误", "无法绑定UDP端口");
     }
 
+    /**
+     * @brief 创建批量接收器
+     * @details 大量网关同时响应广播时，响应会成批到达：每次最多读取32个数据报，
+     *          每个缓冲区按UDP最大载荷分配，任何长度的响应都能完整读取，
+     *          内核接收缓冲区设为256KB容纳突发
+     */
+    receiver = std::make_unique<DatagramReceiver>(udpSocket, 32, 65536, 256 * 1024);
+
     /**
      * @brief QObject::connect()函数（绑定udpSocket的readyRead信号）
      * @param sender 信号发送者（udpSocket）
@@ -51,6 +60,7 @@ SearchUpgrade::SearchUpgrade(QWidget* parent) :
     connect(udpSocket, &QUdpSocket::readyRead, this, &SearchUpgrade::readPendingDatagrams);
     connect(ui->pushButtonClose, &QPushButton::clicked, this, &SearchUpgrade::onCloseClicked);
     connect(ui->listWidgetClients, &QListWidget::itemDoubleClicked, this, &SearchUpgrade::onClientDoubleClicked);
+    connect(ui->pushButtonControlCenter, &QPushButton::clicked, this, &SearchUpgrade::onControlCenterClicked);
     /**
      * @brief QTimer::singleShot()函数
      * @param msec 延迟时间（毫秒）
@@ -130,59 +140,58 @@ void SearchUpgrade::sendBroadcast() {
  * @details 循环读取所有待处理的数据报，解析JSON格式的设备响应，提取设备信息并添加到列表
  */
 void SearchUpgrade::readPendingDatagrams() {
-    // 循环读取所有待处理的数据报
-    while (udpSocket->hasPendingDatagrams()) {
-        QByteArray datagram="";  // 存储接收的数据
-        datagram.resize(udpSocket->pendingDatagramSize());  // 调整数据大小为待接收数据报的大小
-        QHostAddress sender;  // 存储发送者地址
-        quint16 senderPort;  // 存储发送者端口
+    // 按批读取所有待处理的数据报
+    while (const int count = receiver->receiveBatch()) {
+        for (int i = 0; i < count; ++i) {
+            handleDatagram(receiver->datagram(i));
+        }
+    }
+}
 
-        /**
-         * @brief 首次调用QUdpSocket::readDatagram()函数
-         * @param data 接收数据的缓冲区
-         * @param maxSize 缓冲区最大大小
-         * @param sender 发送者地址输出参数
-         * @param senderPort 发送者端口输出参数
-         * @return 实际读取的字节数，失败返回-1
-         * @details 从UDP套接字读取数据报内容及发送者信息
-         */
-        udpSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+/**
+ * @brief 解析一个设备响应数据报
+ * @param received 接收到的数据报（数据指向接收器的缓冲区）
+ * @details 解析JSON格式的设备响应，提取设备信息并添加到列表
+ */
+void SearchUpgrade::handleDatagram(const DatagramReceiver::Datagram& received) {
+    // 数据报在接收缓冲区中，以不复制的方式交给JSON解析
+    const QByteArray datagram = QByteArray::fromRawData(received.data, received.size);
+    const QHostAddress& sender = received.sender;  // 发送者地址
 
-        QJsonParseError error;  // 存储JSON解析错误信息
-        /**
-         * @brief 首次调用QJsonDocument::fromJson()函数
-         * @param json 待解析的JSON字节数组
-         * @param error 解析错误信息输出参数
-         * @return 解析后的QJsonDocument对象
-         * @details 将接收到的字节数组解析为JSON文档
-         */
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(datagram, &error);
-
-        // 检查解析是否成功且为JSON对象
-        if (error.error == QJsonParseError::NoError && jsonDoc.isObject()) {
-            QJsonObject jsonObj = jsonDoc.object();  // 获取JSON对象
-
-            // 检查消息类型是否为0（设备响应）且发送者为IPv4
-            if (jsonObj.contains("type") && jsonObj["type"].toInt() == 0 &&
-                sender.protocol() == QAbstractSocket::IPv4Protocol) {
-
-                // 检查是否包含data字段且为对象
-                if (jsonObj.contains("data") && jsonObj["data"].isObject()) {
-                    QJsonObject dataObj = jsonObj["data"].toObject();  // 获取data对象
-                    QString mqttTopic = dataObj["mqtt_topic_report"].toString();  // 提取MQTT主题
-                    QString ipAddress = sender.toString();  // 获取发送者IP地址
-
-                    ui->labelStatus->setText(QString("发现设备: %1").arg(ipAddress));  // 更新状态标签
-
-                    // 构建列表项显示文本（IP地址 + MQTT主题）
-                    QString displayText = QString("%1 %2").arg(ipAddress, mqttTopic);
-                    /**
-                     * @brief 首次调用QListWidget::addItem()函数
-                     * @param text 列表项显示文本
-                     * @details 向列表控件添加设备信息项
-                     */
-                    ui->listWidgetClients->addItem(displayText);
-                }
+    QJsonParseError error;  // 存储JSON解析错误信息
+    /**
+     * @brief 首次调用QJsonDocument::fromJson()函数
+     * @param json 待解析的JSON字节数组
+     * @param error 解析错误信息输出参数
+     * @return 解析后的QJsonDocument对象
+     * @details 将接收到的字节数组解析为JSON文档
+     */
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(datagram, &error);
+
+    // 检查解析是否成功且为JSON对象
+    if (error.error == QJsonParseError::NoError && jsonDoc.isObject()) {
+        QJsonObject jsonObj = jsonDoc.object();  // 获取JSON对象
+
+        // 检查消息类型是否为0（设备响应）且发送者为IPv4
+        if (jsonObj.contains("type") && jsonObj["type"].toInt() == 0 &&
+            sender.protocol() == QAbstractSocket::IPv4Protocol) {
+
+            // 检查是否包含data字段且为对象
+            if (jsonObj.contains("data") && jsonObj["data"].isObject()) {
+                QJsonObject dataObj = jsonObj["data"].toObject();  // 获取data对象
+                QString mqttTopic = dataObj["mqtt_topic_report"].toString();  // 提取MQTT主题
+                QString ipAddress = sender.toString();  // 获取发送者IP地址
+
+                ui->labelStatus->setText(QString("发现设备: %1").arg(ipAddress));  // 更新状态标签
+
+                // 构建列表项显示文本（IP地址 + MQTT主题）
+                QString displayText = QString("%1 %2").arg(ipAddress, mqttTopic);
+                /**
+                 * @brief 首次调用QListWidget::addItem()函数
+                 * @param text 列表项显示文本
+                 * @details 向列表控件添加设备信息项
+                 */
+                ui->listWidgetClients->addItem(displayText);
             }
         }
     }
@@ -213,4 +222,21 @@ void SearchUpgrade::onClientDoubleClicked(QListWidgetItem* item) {
         linkPush->connectToDevice(ip, topic);  // 调用LinkPush的方法连接设备
         linkPush->show();  // 显示LinkPush窗口
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 集中控制按钮点击事件处理
+ * @details 将列表中已发现的全部网关加入集中控制窗口，由一个进程同时管理
+ */
+void SearchUpgrade::onControlCenterClicked() {
+    auto* controlCenter = new ControlCenter(this);
+    controlCenter->setWindowFlags(Qt::Window);  // 作为独立窗口显示
+    controlCenter->setAttribute(Qt::WA_DeleteOnClose);  // 关闭时断开全部网关连接
+    for (int i = 0; i < ui->listWidgetClients->count(); ++i) {
+        QStringList parts = ui->listWidgetClients->item(i)->text().split(" ");  // IP和MQTT主题
+        if (parts.size() >= 2) {
+            controlCenter->addGateway(parts[0], parts[1]);
+        }
+    }
+    controlCenter->show();
+}
@@ -7,6 +7,8 @@
 #include <QWidget>
 #include <QUdpSocket>
 #include <QListWidgetItem>  // 包含QListWidgetItem类，用于列表控件的项操作
+#include <memory>
+#include "DatagramReceiver.h"  // 批量接收UDP数据报
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -48,6 +50,12 @@ private slots:
      */
     void onClientDoubleClicked(QListWidgetItem* item);
 
+    /**
+     * @brief 集中控制按钮点击事件处理槽函数
+     * @details 打开集中控制窗口，同时连接列表中的全部网关
+     */
+    void onControlCenterClicked();
+
     /**
      * @brief 读取等待的数据报槽函数
      * @details 当UDP套接字接收到数据时触发，解析设备响应信息
@@ -57,6 +65,7 @@ private slots:
 private:
     Ui::SearchUpgrade* ui;  // UI界面对象指针，用于访问界面控件
     QUdpSocket* udpSocket;  // UDP套接字指针，用于发送和接收广播数据
+    std::unique_ptr<DatagramReceiver> receiver;  // 批量读取设备响应，缓冲区预先分配并复用
     QString latestFirmwareVersion;  // 最新固件版本号
 
     /**
@@ -64,6 +73,13 @@ private:
      * @details 遍历网络接口，向所有IPv4广播地址发送搜索请求
      */
     void sendBroadcast();
+
+    /**
+     * @brief 解析一个设备响应数据报
+     * @param received 接收到的数据报
+     * @details 设备响应有效时添加到设备列表
+     */
+    void handleDatagram(const DatagramReceiver::Datagram& received);
 };
 
 #endif //QTCLIENT_SEARCHUPGRADE_H  // 头文件宏定义结束
\ No newline at end of file